@@ -4,6 +4,12 @@
 #include <assert.h>
 #include <unistd.h>
 #include <ctype.h>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
 
 // Test counter
 int tests_passed = 0;
@@ -397,6 +403,540 @@ void test_file_operations() {
     remove("test_file_ops.csv");
 }
 
+// ========== DURABILITY TESTS ==========
+// These run the real program (./review_system --exec) in a scratch
+// directory: changes go to reviews.csv.wal, the program is stopped or
+// killed, then started again to see what it loaded.
+
+char scratch_dir[64];
+char program_path[512];
+
+void scratch_path(char *path, size_t size, const char *name) {
+    snprintf(path, size, "%s/%s", scratch_dir, name);
+}
+
+void write_scratch_file(const char *name, const char *text, size_t length) {
+    char path[128];
+    scratch_path(path, sizeof(path), name);
+    FILE *file = fopen(path, "w");
+    if (!file || fwrite(text, 1, length, file) != length || fclose(file) != 0) {
+        printf("ERROR: Cannot write %s\n", path);
+        exit(1);
+    }
+}
+
+// Whole file into a new buffer (NUL terminated), NULL if it is missing
+char* read_scratch_file(const char *name, size_t *length) {
+    char path[128];
+    scratch_path(path, sizeof(path), name);
+    FILE *file = fopen(path, "r");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *text = malloc(size + 1);
+    size_t got = fread(text, 1, size, file);
+    fclose(file);
+    text[got] = '\0';
+    if (length) *length = got;
+    return text;
+}
+
+long scratch_file_size(const char *name) {
+    char path[128];
+    struct stat st;
+    scratch_path(path, sizeof(path), name);
+    return stat(path, &st) == 0 ? (long)st.st_size : -1;
+}
+
+int scratch_file_contains(const char *name, const char *text) {
+    char *data = read_scratch_file(name, NULL);
+    int found = data && strstr(data, text) != NULL;
+    free(data);
+    return found;
+}
+
+// Start over with the test CSV and no log or snapshot
+void reset_scratch() {
+    const char *names[] = {"reviews.csv.wal", "reviews.csv.wal.tmp", "reviews.csv.snap", "script.txt", "output.txt"};
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        char path[128];
+        scratch_path(path, sizeof(path), names[i]);
+        remove(path);
+    }
+    char path[128];
+    scratch_path(path, sizeof(path), "reviews.csv");
+    create_test_csv(path);
+}
+
+// Run the program on script in the scratch directory. Its output (answers
+// and messages) ends up in output, returns the exit status.
+int run_script(const char *script, char **output) {
+    write_scratch_file("script.txt", script, strlen(script));
+    char command[1024];
+    snprintf(command, sizeof(command), "cd %s && %s --exec script.txt > output.txt 2>&1", scratch_dir, program_path);
+    int status = system(command);
+    *output = read_scratch_file("output.txt", NULL);
+    if (!*output) *output = calloc(1, 1);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+// Same, but feeding input to the interactive menu
+int run_menu(const char *input, char **output) {
+    write_scratch_file("script.txt", input, strlen(input));
+    char command[1024];
+    snprintf(command, sizeof(command), "cd %s && %s < script.txt > output.txt 2>&1", scratch_dir, program_path);
+    int status = system(command);
+    *output = read_scratch_file("output.txt", NULL);
+    if (!*output) *output = calloc(1, 1);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+int count_ok_lines(const char *text) {
+    int count = 0;
+    for (const char *p = text; (p = strstr(p, "ok\n")) != NULL; p += 3) {
+        if (p == text || p[-1] == '\n') count++;
+    }
+    return count;
+}
+
+int setup_durability_tests() {
+    if (!getcwd(program_path, sizeof(program_path) - 16)) return 0;
+    strcat(program_path, "/review_system");
+    snprintf(scratch_dir, sizeof(scratch_dir), "/tmp/review_e2e_XXXXXX");
+    if (access(program_path, X_OK) != 0 || !mkdtemp(scratch_dir)) return 0;
+    unsetenv("REVIEW_WAL");  // the log must be on
+    return 1;
+}
+
+void cleanup_durability_tests() {
+    const char *names[] = {"reviews.csv", "reviews.csv.wal", "reviews.csv.wal.tmp", "reviews.csv.snap",
+                           "reviews.csv.snap.tmp", "script.txt", "output.txt", "merge.ndjson"};
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        char path[128];
+        scratch_path(path, sizeof(path), names[i]);
+        remove(path);
+    }
+    rmdir(scratch_dir);
+}
+
+// Start the program in the scratch directory reading script from a pipe
+// that stays open, so it waits for more once the script is done. Returns
+// its pid, *input is the write end.
+pid_t start_piped_script(const char *script, int *input) {
+    int fds[2];
+    if (pipe(fds) != 0) return -1;
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (chdir(scratch_dir) != 0) _exit(127);
+        int out = open("output.txt", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        dup2(fds[0], STDIN_FILENO);
+        dup2(out, STDOUT_FILENO);
+        dup2(out, STDERR_FILENO);
+        close(fds[1]);
+        execl(program_path, "review_system", "--exec", "-", (char*)NULL);
+        _exit(127);
+    }
+    close(fds[0]);
+    *input = fds[1];
+    if (pid < 0 || write(fds[1], script, strlen(script)) != (ssize_t)strlen(script)) {
+        close(fds[1]);
+        return -1;
+    }
+    return pid;
+}
+
+// Wait (up to 5 s) until the program has answered "ok" on its own line
+// this many times. Answers are let out only after a sync.
+int wait_for_ok_lines(int count) {
+    for (int wait = 0; wait < 500; wait++) {
+        char *output = read_scratch_file("output.txt", NULL);
+        int seen = output ? count_ok_lines(output) : 0;
+        free(output);
+        if (seen >= count) return 1;
+        usleep(10000);
+    }
+    return 0;
+}
+
+void kill_piped_script(pid_t pid, int input) {
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+    close(input);
+}
+
+void test_wal_survives_kill() {
+    printf("\n=== Test: Committed Changes Survive a Kill ===\n");
+    reset_scratch();
+
+    // Kill the program once the commit answered: three oks = on disk
+    int input;
+    pid_t pid = start_piped_script("add Kim,5,2024-02-01,Kept after a crash\nadd Lee,1,2024-02-02,Also kept\ncommit\n", &input);
+    int committed = pid > 0 && wait_for_ok_lines(3);
+    if (pid > 0) kill_piped_script(pid, input);
+    TEST_ASSERT(committed, "Commit answered before the kill");
+    TEST_ASSERT(!scratch_file_contains("reviews.csv", "Kim"), "CSV itself not rewritten");
+
+    char *output;
+    run_script("query name Kim\nstats\n", &output);
+    TEST_ASSERT(strstr(output, "Recovered 2 change(s)") != NULL, "Log replayed on restart");
+    TEST_ASSERT(strstr(output, "ok 1\nKim,5,2024-02-01,Kept after a crash\n") != NULL, "Killed session's row is back");
+    TEST_ASSERT(strstr(output, "ok count=7 ") != NULL, "Row count after recovery");
+    free(output);
+}
+
+void test_wal_torn_record() {
+    printf("\n=== Test: Torn Last Log Record ===\n");
+    reset_scratch();
+
+    char *output;
+    run_script("add Kim,5,2024-02-01,Kept\nadd Lee,1,2024-02-02,Also kept\n", &output);
+    free(output);
+    long good_size = scratch_file_size("reviews.csv.wal");
+
+    // A crash in the middle of a write: the length says 40 bytes, 10 made it
+    size_t length;
+    char *log = read_scratch_file("reviews.csv.wal", &length);
+    log = realloc(log, length + 18);
+    uint32_t record_length = 40, checksum = 0x12345678;
+    memcpy(log + length, &record_length, 4);
+    memcpy(log + length + 4, &checksum, 4);
+    memset(log + length + 8, 'x', 10);
+    write_scratch_file("reviews.csv.wal", log, length + 18);
+    free(log);
+
+    run_script("stats\n", &output);
+    TEST_ASSERT(strstr(output, "Recovered 2 change(s)") != NULL, "Records before the torn one replayed");
+    TEST_ASSERT(strstr(output, "ok count=7 ") != NULL, "Torn record ignored");
+    TEST_ASSERT(scratch_file_size("reviews.csv.wal") == good_size, "Torn tail cut off the log");
+    free(output);
+}
+
+void test_wal_for_older_csv() {
+    printf("\n=== Test: Log Left From an Older CSV ===\n");
+    reset_scratch();
+
+    char *output;
+    run_script("add Kim,5,2024-02-01,Kept\nadd Lee,1,2024-02-02,Also kept\n", &output);
+    free(output);
+    size_t length;
+    char *old_log = read_scratch_file("reviews.csv.wal", &length);
+
+    // The checkpoint writes the rows into the CSV, a crash before the new log
+    // is in place would leave the old one
+    run_script("save\n", &output);
+    TEST_ASSERT(scratch_file_contains("reviews.csv", "Kim,5,2024-02-01,Kept"), "Save folds the log into the CSV");
+    free(output);
+    write_scratch_file("reviews.csv.wal", old_log, length);
+    free(old_log);
+
+    run_script("stats\n", &output);
+    TEST_ASSERT(strstr(output, "Ignoring") != NULL, "Log of the older CSV is not replayed");
+    TEST_ASSERT(strstr(output, "ok count=7 ") != NULL, "No row applied twice");
+    free(output);
+}
+
+void test_wal_checkpoint_threshold() {
+    printf("\n=== Test: Log Checkpoint Threshold ===\n");
+    reset_scratch();
+
+    char *output;
+    run_script("add Small,3,2024-03-01,Stays in the log\n", &output);
+    free(output);
+    TEST_ASSERT(!scratch_file_contains("reviews.csv", "Small"), "Small log: CSV not rewritten");
+
+    // About 1.5 MB of log over a tiny CSV: past WAL_CHECKPOINT_BYTES and a
+    // quarter of the CSV, so a commit folds it into the CSV
+    size_t capacity = 12000 * 160, used = 0;
+    char *script = malloc(capacity);
+    for (int i = 0; i < 12000; i++) {
+        used += snprintf(script + used, capacity - used, "add Bulk%d,4,2024-03-02,%.*s\n", i, 100,
+                         "A long enough feedback line to make the log grow by over a hundred bytes per row, padded out here");
+    }
+    run_script(script, &output);
+    free(script);
+    TEST_ASSERT(scratch_file_contains("reviews.csv", "Bulk0,4,2024-03-02,"), "Big log: checkpoint rewrote the CSV");
+    TEST_ASSERT(scratch_file_size("reviews.csv.wal") < 1024 * 1024, "Log started over after the checkpoint");
+    free(output);
+
+    run_script("stats\n", &output);
+    TEST_ASSERT(strstr(output, "ok count=12006 ") != NULL, "Every row there after a restart");
+    free(output);
+}
+
+// 270,000 rows by one name plus one other, about 1.6 MB of CSV: deleting
+// the name logs one record of over WAL_FLUSH_BYTES (4 bytes a row).
+// tail (whole lines) goes after them.
+void write_bulk_delete_csv(const char *tail) {
+    size_t capacity = 270000 * 6 + strlen(tail) + 128, used = 0;
+    char *csv = malloc(capacity);
+    used += snprintf(csv, capacity, "ReviewerName,SatisfactionScore,ReviewDate,Feedback\nOther,3,2024-01-01,Kept\n");
+    for (int i = 0; i < 270000; i++) {
+        memcpy(csv + used, "A,3,,\n", 6);
+        used += 6;
+    }
+    memcpy(csv + used, tail, strlen(tail));
+    used += strlen(tail);
+    write_scratch_file("reviews.csv", csv, used);
+    free(csv);
+}
+
+void test_wal_big_record() {
+    printf("\n=== Test: Log Record Bigger Than One Write Group ===\n");
+    reset_scratch();
+    write_bulk_delete_csv("");
+
+    // The record is written as soon as it is built, the commit at the end
+    // must still sync it, and then checkpoint (the log is over a quarter of
+    // the CSV), which only happens after a good sync
+    char *output;
+    run_script("delete A\n", &output);
+    TEST_ASSERT(strstr(output, "ok 270000\n") != NULL, "Bulk delete answered");
+    TEST_ASSERT(scratch_file_size("reviews.csv") < 1024, "Commit synced the big record and checkpointed");
+    free(output);
+
+    run_script("stats\n", &output);
+    TEST_ASSERT(strstr(output, "ok count=1 ") != NULL, "Only the other row after a restart");
+    free(output);
+}
+
+void test_batch_commit_after_big_delete() {
+    printf("\n=== Test: Batch Commit After a Bulk Delete ===\n");
+    reset_scratch();
+    write_bulk_delete_csv("");
+
+    // When commit answers, the sync (and the checkpoint that follows it)
+    // must be done already, while the program still runs
+    int input;
+    pid_t pid = start_piped_script("delete A\ncommit\n", &input);
+    int committed = pid > 0 && wait_for_ok_lines(1);
+    int checkpointed = scratch_file_size("reviews.csv") < 1024;
+    if (pid > 0) kill_piped_script(pid, input);
+    TEST_ASSERT(committed, "Commit answered");
+    TEST_ASSERT(checkpointed, "Commit synced before answering");
+
+    char *output;
+    run_script("stats\n", &output);
+    TEST_ASSERT(strstr(output, "ok count=1 ") != NULL, "Delete kept after the kill");
+    free(output);
+}
+
+// The CSV should now hold exactly these rows after the header
+int scratch_csv_is(const char *rows) {
+    char *csv = read_scratch_file("reviews.csv", NULL);
+    const char *header = "ReviewerName,SatisfactionScore,ReviewDate,Feedback\n";
+    int same = csv && strncmp(csv, header, strlen(header)) == 0 && strcmp(csv + strlen(header), rows) == 0;
+    free(csv);
+    return same;
+}
+
+void test_undo_across_compaction() {
+    printf("\n=== Test: Undo a Bulk Delete Across a Compaction ===\n");
+    reset_scratch();
+    write_bulk_delete_csv("Bob,4,2024-01-02,First\nBob,2,2024-01-03,Second\n");
+
+    // With a 1 MB journal, deleting Bob drops the entry for the A rows, so
+    // they are plain tombstones and the compaction that follows moves Bob's
+    // rows from the end of the table to the front. Undo must find them there.
+    char *output;
+    setenv("REVIEW_UNDO_MB", "1", 1);
+    run_menu("5\n3\nA\n5\n3\nBob\n8\n8\n9\n", &output);
+    unsetenv("REVIEW_UNDO_MB");
+    TEST_ASSERT(strstr(output, "Deleted 2 review(s) by Bob") != NULL, "Bulk delete done");
+    TEST_ASSERT(strstr(output, "2 reviews restored successfully") != NULL, "Bulk delete undone");
+    TEST_ASSERT(strstr(output, "Nothing to undo") != NULL, "Older entry trimmed");
+    TEST_ASSERT(scratch_csv_is("Other,3,2024-01-01,Kept\nBob,4,2024-01-02,First\nBob,2,2024-01-03,Second\n"),
+                "The undone rows are the ones deleted");
+    free(output);
+}
+
+void test_redo_after_checkpoint() {
+    printf("\n=== Test: Redo After a Checkpoint ===\n");
+    reset_scratch();
+    write_bulk_delete_csv("Bob,4,2024-01-02,First\nBob,2,2024-01-03,Second\n");
+
+    // Undoing the big delete logs 270,000 rows again, the commit after it
+    // checkpoints (renumbering the log ids) before both deletes are redone
+    char *output;
+    run_menu("5\n3\nA\n5\n3\nBob\n8\n8\n10\n10\n9\n", &output);
+    const char *undone = strstr(output, "270000 reviews restored successfully");
+    const char *redone = strstr(output, "Deleting 270000 review(s) by A again");
+    const char *checkpoint = undone ? strstr(undone, "Saved to reviews.csv") : NULL;
+    TEST_ASSERT(undone && redone, "Both deletes undone and redone");
+    TEST_ASSERT(checkpoint && checkpoint < redone, "Checkpoint between undo and redo");
+    TEST_ASSERT(strstr(output, "Deleting 2 review(s) by Bob again") != NULL, "Second delete redone");
+    TEST_ASSERT(scratch_csv_is("Other,3,2024-01-01,Kept\n"), "Only the other row is saved");
+    free(output);
+
+    run_script("stats\n", &output);
+    TEST_ASSERT(strstr(output, "ok count=1 ") != NULL, "Only the other row after a restart");
+    free(output);
+}
+
+void test_undo_trim() {
+    printf("\n=== Test: Undo Journal Trimmed to REVIEW_UNDO_MB ===\n");
+    reset_scratch();
+    write_bulk_delete_csv("Bob,4,2024-01-02,First\n");
+
+    // The A delete alone is over 1 MB: it is kept (the newest entry always
+    // is) and the Bob delete before it goes, for good
+    char *output;
+    setenv("REVIEW_UNDO_MB", "1", 1);
+    run_menu("5\n3\nBob\n5\n3\nA\n8\n8\n9\n", &output);
+    unsetenv("REVIEW_UNDO_MB");
+    TEST_ASSERT(strstr(output, "270000 reviews restored successfully") != NULL, "Newest entry kept over the limit");
+    TEST_ASSERT(strstr(output, "Restoring deleted review") == NULL && strstr(output, "Nothing to undo") != NULL,
+                "Oldest entry trimmed");
+    TEST_ASSERT(scratch_file_contains("reviews.csv", "Other,3,2024-01-01,Kept\nA,3,,\n") &&
+                !scratch_file_contains("reviews.csv", "Bob"), "Trimmed delete stays done");
+    free(output);
+
+    run_script("stats\n", &output);
+    TEST_ASSERT(strstr(output, "ok count=270001 ") != NULL, "A rows back after a restart");
+    free(output);
+}
+
+void test_date_range_query() {
+    printf("\n=== Test: Date Range Query ===\n");
+    reset_scratch();
+    const char *csv = "ReviewerName,SatisfactionScore,ReviewDate,Feedback\n"
+                      "Before,3,2025-07-31,Day before\n"
+                      "Buddhist,4,2568-08-01,BE date\n"
+                      "After,5,2025-08-02,Last day\n"
+                      "Later,2,2025-08-03,Day after\n";
+    write_scratch_file("reviews.csv", csv, strlen(csv));
+
+    // A CE range finds the BE row for the same day, both ends included
+    char *output;
+    int status = run_script("query date 2025-08-01 2025-08-02\n"
+                            "query date 2568-08-01 2568-08-01\n"
+                            "query date 2025-08-02 2025-08-01\n", &output);
+    TEST_ASSERT(strstr(output, "ok 2\nBuddhist,4,2568-08-01,BE date\nAfter,5,2025-08-02,Last day\n") != NULL,
+                "CE range includes the BE row and both ends");
+    TEST_ASSERT(strstr(output, "ok 1\nBuddhist,") != NULL, "BE range of one day");
+    TEST_ASSERT(strstr(output, "ok 0\n") != NULL, "Reversed range finds nothing");
+    TEST_ASSERT(status == 0 && strstr(output, "Before,") == NULL && strstr(output, "Later,") == NULL,
+                "Days outside the range left out");
+    free(output);
+
+    status = run_script("query date 2025-02-30 2025-08-01\n", &output);
+    TEST_ASSERT(status == 1 && strncmp(output, "error ", 6) == 0, "Invalid date finds nothing");
+    free(output);
+}
+
+void test_last_days_search() {
+    printf("\n=== Test: Search the Last N Days ===\n");
+    reset_scratch();
+
+    // Dates relative to today: today, 6 days ago (in) and 7 days ago (out)
+    char csv[512], dates[3][11];
+    int back[3] = {0, 6, 7};
+    for (int i = 0; i < 3; i++) {
+        time_t when = time(NULL);
+        struct tm day = *localtime(&when);
+        day.tm_mday -= back[i];
+        day.tm_hour = 12;  // clear of a daylight saving change
+        mktime(&day);
+        strftime(dates[i], sizeof(dates[i]), "%Y-%m-%d", &day);
+    }
+    snprintf(csv, sizeof(csv), "ReviewerName,SatisfactionScore,ReviewDate,Feedback\n"
+             "Today,5,%s,New\nSixDays,4,%s,Recent\nSevenDays,3,%s,Too old\n", dates[0], dates[1], dates[2]);
+    write_scratch_file("reviews.csv", csv, strlen(csv));
+
+    char *output;
+    run_menu("3\n4\n7\n3\n4\n0\n9\n", &output);
+    TEST_ASSERT(strstr(output, "Found 2 reviews.") != NULL, "Two reviews in the last 7 days");
+    TEST_ASSERT(strstr(output, "Today") != NULL && strstr(output, "SixDays") != NULL, "Today and 6 days ago found");
+    TEST_ASSERT(strstr(output, "SevenDays") == NULL, "7 days ago left out");
+    TEST_ASSERT(strstr(output, "Number of days must be at least 1") != NULL, "0 days refused");
+    free(output);
+}
+
+void test_merge_skips_duplicates() {
+    printf("\n=== Test: Merge Skips Duplicates ===\n");
+    reset_scratch();
+    // A row already loaded, a new one, the new one again and a bad score
+    const char *ndjson = "{\"name\": \"Alice\", \"score\": 5, \"date\": \"2024-01-15\", \"feedback\": \"Excellent service\"}\n"
+                         "{\"name\": \"Frank\", \"score\": 4, \"date\": \"2024-02-01\", \"feedback\": \"New here\"}\n"
+                         "{\"name\": \"Frank\", \"score\": 4, \"date\": \"2024-02-01\", \"feedback\": \"New here\"}\n"
+                         "{\"name\": \"Gina\", \"score\": 9, \"date\": \"2024-02-02\", \"feedback\": \"Too high\"}\n";
+    write_scratch_file("merge.ndjson", ndjson, strlen(ndjson));
+
+    char *output;
+    int status = run_script("merge merge.ndjson\nmerge merge.ndjson\nquery name Frank\n", &output);
+    TEST_ASSERT(status == 0, "Merges ran");
+    TEST_ASSERT(strncmp(output, "ok added=1 invalid=1 duplicates=2\n", 34) == 0, "One added, one invalid, two duplicates");
+    TEST_ASSERT(strstr(output, "ok added=0 invalid=1 duplicates=3\n") != NULL, "Merging again adds nothing");
+    TEST_ASSERT(strstr(output, "ok 1\nFrank,4,2024-02-01,New here\n") != NULL, "The new row is in once");
+    free(output);
+
+    run_script("stats\n", &output);
+    TEST_ASSERT(strstr(output, "ok count=6 ") != NULL, "Six rows after a restart");
+    free(output);
+}
+
+void test_partial_match_without_shared_trigram() {
+    printf("\n=== Test: Partial Match Sharing No Trigram ===\n");
+    reset_scratch();
+    const char *csv = "Name,Score,Date,Feedback\n"
+                      "Qabxd Smith,4,2024-01-01,Fine\n"
+                      "Zed Abxd,3,2024-01-02,Okay\n";
+    write_scratch_file("reviews.csv", csv, strlen(csv));
+
+    // "abxd" is one edit from "abcd" but shares none of its trigrams
+    // with "qabxd smith", so the search must not insist on one
+    char *output;
+    int status = run_menu("3\n1\nabcd\n9\n", &output);
+    TEST_ASSERT(status == 0, "Search ran");
+    TEST_ASSERT(strstr(output, "Zed Abxd") != NULL, "Partial match at the start of a word found");
+    TEST_ASSERT(strstr(output, "Qabxd Smith") != NULL, "Partial match inside a word found");
+    free(output);
+}
+
+void test_snapshot_load() {
+    printf("\n=== Test: Snapshot Load and CRC Fallback ===\n");
+    reset_scratch();
+
+    char *output;
+    run_script("save\n", &output);
+    free(output);
+    TEST_ASSERT(scratch_file_size("reviews.csv.snap") > 0, "Save writes a snapshot");
+
+    // Change a byte of the CSV but keep its size and time, so only loading
+    // the snapshot still finds Alice
+    char path[128];
+    struct stat st;
+    scratch_path(path, sizeof(path), "reviews.csv");
+    stat(path, &st);
+    size_t length;
+    char *csv = read_scratch_file("reviews.csv", &length);
+    char *alice = strstr(csv, "Alice");
+    if (alice) alice[4] = 'f';
+    int fd = open(path, O_WRONLY);
+    ssize_t written = fd >= 0 ? write(fd, csv, length) : -1;
+    if (fd >= 0) close(fd);
+    free(csv);
+    struct timespec times[2] = {st.st_atim, st.st_mtim};
+    utimensat(AT_FDCWD, path, times, 0);
+    TEST_ASSERT(written == (ssize_t)length, "CSV changed in place");
+
+    run_script("query name Alice\n", &output);
+    TEST_ASSERT(strstr(output, "ok 1\nAlice,5,") != NULL, "Current snapshot is loaded instead of the CSV");
+    free(output);
+
+    // A flipped byte in the snapshot fails its CRC, the CSV is read instead
+    char *snap = read_scratch_file("reviews.csv.snap", &length);
+    snap[length - 2] ^= 0x20;
+    write_scratch_file("reviews.csv.snap", snap, length);
+    free(snap);
+    utimensat(AT_FDCWD, path, times, 0);
+
+    run_script("query name Alice\nquery name Alicf\n", &output);
+    TEST_ASSERT(strstr(output, "is damaged") != NULL, "Damaged snapshot reported");
+    TEST_ASSERT(strstr(output, "ok 0\nok 1\nAlicf,5,") != NULL, "Damaged snapshot falls back to the CSV");
+    free(output);
+}
+
 // ========== MAIN TEST RUNNER ==========
 
 int main() {
@@ -419,6 +959,25 @@ int main() {
     test_memory_management();
     test_edge_cases();
     test_file_operations();
+    if (setup_durability_tests()) {
+        test_wal_survives_kill();
+        test_wal_torn_record();
+        test_wal_for_older_csv();
+        test_wal_checkpoint_threshold();
+        test_wal_big_record();
+        test_batch_commit_after_big_delete();
+        test_snapshot_load();
+        test_partial_match_without_shared_trigram();
+        test_undo_across_compaction();
+        test_redo_after_checkpoint();
+        test_undo_trim();
+        test_date_range_query();
+        test_last_days_search();
+        test_merge_skips_duplicates();
+        cleanup_durability_tests();
+    } else {
+        TEST_ASSERT(0, "./review_system built for the durability tests");
+    }
     
     // Cleanup
     cleanup_test_files();
@@ -2,9 +2,36 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <limits.h>
 #include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
 
-// Structure for user data
+// SIMD statistics kernels are x86 only, other CPUs use the plain C loop
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SCORE_STATS_X86 1
+#else
+#define SCORE_STATS_X86 0
+#endif
+
+// The CSV scanner uses SSE2, which every x86-64 CPU has
+#if defined(__SSE2__)
+#define CSV_SCAN_SSE2 1
+#else
+#define CSV_SCAN_SSE2 0
+#endif
+
+// Structure for user data (one row, the table itself is stored by column)
 typedef struct {
     char *reviewer_name;
     int satisfaction_score;
@@ -18,52 +45,758 @@ typedef struct {
     char matchType[20];
 } SearchResult;
 
+// Called once per matching row, return nonzero to stop the search
+typedef int (*SearchCallback)(int index, int distance, void *context);
+
+// Best 'limit' hits of a search (one per worker in a parallel search).
+// Kept as a max-heap on (distance, index) so the worst hit is at items[0]
+// and can be dropped in O(log limit) when a better one comes in.
+typedef struct {
+    SearchResult *items;
+    int count;
+    int capacity;
+    int limit;
+    int total;  // every hit offered, kept or not
+} ResultBuffer;
+
+// What the workers of a parallel BK-tree search share
+typedef struct {
+    const int *nodes;         // one subtree root per task
+    const char *lower_query;
+    int maxDistance;
+    ResultBuffer *buffers;    // one per worker
+} BKSearchJob;
+
+// One step of the undo journal (see undo_record). The journal never copies
+// review strings: deleted rows stay in the table as pinned tombstones until
+// their entry is dropped, and an update entry owns the values it replaced.
+typedef enum {
+    UNDO_ADD,
+    UNDO_UPDATE,
+    UNDO_DELETE      // one row or a whole bulk delete
+} UndoKind;
+
+typedef struct {
+    UndoKind kind;
+    int *rows;       // rows the step touched
+    int row_count;
+    Review swap;     // UNDO_UPDATE: the other version of each changed field,
+                     // NULL / score -1 = field not changed
+    size_t bytes;    // memory the entry keeps alive, counted against the cap
+} UndoEntry;
+
+// Identity of a file on disk, all 0 = the file does not exist (see file_stamp)
+typedef struct {
+    uint64_t inode;
+    uint64_t size;
+    int64_t mtime_ns;
+} FileStamp;
+
+// First bytes of a write-ahead log file (see wal_replay). The log only applies
+// to the exact CSV it was started for, a CSV with another identity means a
+// checkpoint finished after the log was written.
+typedef struct {
+    char magic[8];        // WAL_MAGIC
+    FileStamp base;
+} WalHeader;
+
+// Log records: uint32 payload length, uint32 checksum, then the payload (a
+// type byte and its fields, host byte order). Rows are named by review_ids.
+typedef enum {
+    WAL_ADD = 'A',     // name, score, date, feedback: new row at the end
+    WAL_UPDATE = 'U',  // id, name, score, date, feedback
+    WAL_DELETE = 'D',  // count, ids
+    WAL_REVIVE = 'R',  // count, ids: deleted rows back where they were
+    WAL_INSERT = 'I'   // id of the row before it (-1 = first), name, score,
+                       // date, feedback: a row the log has no id for comes back
+} WalRecordType;
+
+#define WAL_MAGIC "REVWAL1\n"
+
+// Block of a snapshot file, see save_snapshot()
+typedef struct {
+    uint64_t offset;      // from the start of the file, a multiple of SNAP_ALIGN
+    uint64_t size;
+    uint32_t crc;         // CRC32C of the block
+    uint32_t reserved;
+} SnapBlock;
+
+typedef enum {
+    SNAP_SCORES,          // uint8 per row
+    SNAP_DATE_KEYS,       // int32 per row (pack_date)
+    SNAP_OFFSETS,         // uint64 name, date, feedback offset into the heap per row
+    SNAP_HEAP,            // the strings, '\0' terminated
+    SNAP_BLOCK_COUNT
+} SnapBlockId;
+
+typedef struct {
+    char magic[8];        // SNAP_MAGIC
+    uint32_t version;     // SNAP_VERSION, other versions are ignored
+    uint32_t block_count;
+    uint64_t row_count;
+    FileStamp csv;        // the CSV file this is a copy of
+    SnapBlock blocks[SNAP_BLOCK_COUNT];
+    uint32_t header_crc;  // CRC32C of everything above
+    uint32_t reserved;
+} SnapHeader;
+
+#define SNAP_MAGIC "REVSNAP\n"
+#define SNAP_VERSION 1
+#define SNAP_ALIGN 64
+
+// Incremental backups (see backup_reviews). With typical rows (60 bytes) a
+// chunk holds about 8 KB.
+#define BACKUP_MAGIC "REVIEW-BACKUP 1"
+#define BACKUP_CHUNK_DIR "backup_chunks"
+#define CHUNK_MIN_SIZE 2048
+#define CHUNK_MAX_SIZE 65536
+#define CHUNK_ROW_MASK 0x7F   // 1 row in 128 may end a chunk
+
+// Chunks are stored compressed, the codec is the file name's extension.
+// zlib when the build has it (see makefile), the built-in LZ otherwise.
+#ifdef HAVE_ZLIB
+#define CHUNK_CODEC_EXT ".z"  // raw deflate
+#define CHUNK_ZLIB_LEVEL 1
+#else
+#define CHUNK_CODEC_EXT ".lz"  // lz_compress()
+#endif
+#define LZ_HASH_BITS 13
+#define LZ_MIN_MATCH 4
+
+// Chunk of a backup: its content name and the first row it holds (it runs
+// up to the next chunk's first row)
+typedef struct {
+    int first_row;
+    int changed;          // lost a changed row to compaction
+    char name[48];        // content name and codec extension
+} BackupChunk;
+
+// State of a backup being written (see backup_cut_chunk)
+typedef struct {
+    char *text;           // text of the chunk being cut
+    size_t text_size;
+    size_t text_capacity;
+    char *packed;         // the same, compressed
+    size_t packed_capacity;
+    FILE *manifest;
+    BackupChunk *chunks;  // chunks listed so far
+    int chunk_count;
+    int chunk_capacity;
+    int new_chunks;       // chunks the store did not have yet
+    size_t new_bytes;     // compressed size of the new chunks
+    int ok;
+} BackupWriter;
+
+// Called with the text of every chunk of a manifest, in order
+typedef void (*ChunkCallback)(char *text, size_t length, void *context);
+
+// Called with every record load_chunk_rows() puts together, without its '\n'
+typedef void (*LineCallback)(char *line, void *context);
+
+// Where csv_find_record_end() stopped, all 0 at the start of a record
+typedef struct {
+    int in_quotes;        // inside a quoted part of a field
+    int quote_is_text;    // a '"' at the next byte is plain text, not an opening quote
+    int field;            // fields started so far after the first
+} CsvScanState;
+
+// Reader that cuts the records of a writable buffer in place (see csv_read_record)
+typedef struct {
+    char *next;           // start of the next record
+    char *end;            // end of the buffer, *end must be writable too
+    char *block;          // the 64 bytes the bits are for, NULL = none yet
+    uint64_t bits;        // ',', '"' and '\n' in block
+    int unclosed;         // the last record ran into the end inside quotes
+} CsvReader;
+
+// Output of save_reviews_to_csv(): rows are formatted straight into buffer,
+// which goes to fd in big write() calls
+typedef struct {
+    int fd;
+    char *buffer;
+    size_t used;
+    size_t capacity;
+    int ok;               // every write so far went through
+} CsvWriter;
+
+// State of load_reviews_manifest(), load_reviews_stream() and stream_report()
+typedef struct {
+    char *partial;        // start of a record cut by a chunk border
+    size_t partial_size;
+    size_t partial_capacity;
+    int skip_header;
+    CsvScanState scan;    // where the record cut by the border stands
+    LineCallback visit_line;  // NULL = append the row to the table
+    void *context;
+    int plain_lines;      // every '\n' ends a record (NDJSON), no CSV quoting
+} ManifestLoad;
+
+#define STREAM_BLOCK_SIZE 65536  // read size of read_csv_records()
+#define IMPORT_REINDEX_ROWS 1024  // bigger imports drop the indexes (built again when next needed)
+#define BATCH_COMMIT_COMMANDS 1024  // run_batch() commits (one sync) after this many commands
+
+// Filters and running totals of a streaming report (see stream_report).
+// 64-bit counters, the file may hold more rows than fit in memory.
+typedef struct {
+    int min_score;        // score filter, 0-255 = any
+    int max_score;
+    int filter_dates;     // keep only valid dates in [first_day, last_day]
+    int32_t first_day;
+    int32_t last_day;
+    const char *query;    // folded name to look for, NULL = any
+    int max_edits;        // partial_tolerance() of the query
+    int show_rows;        // print matching rows as they are read
+    char *folded;         // scratch for the folded name of a row
+    size_t folded_capacity;
+    long long rows;       // reviews read
+    long long skipped;    // lines that are not a review
+    long long matched;
+    long long counts[5];  // counts[s - 1] = matching reviews with score s
+    long long out_of_range;
+    long long sum;        // sum of the 1-5 scores
+    int min_score_seen;
+    int max_score_seen;
+    int32_t first_seen;   // day_number() of the earliest valid date, 0 = none yet
+    int32_t last_seen;
+    char first_date[16];
+    char last_date[16];
+} StreamReport;
+
+// Set of (name, date, feedback) keys: open addressing on a CRC32C of the
+// key, the hash sits next to the row so a probe touches one cache line
+typedef struct {
+    uint32_t hash;        // 0 = empty slot
+    int32_t row;          // row holding the key
+} ReviewKeySlot;
+
+typedef struct {
+    ReviewKeySlot *slots;
+    size_t mask;          // slot count - 1, a power of two
+} ReviewKeySet;
+
+// State and counts of import_reviews()
+typedef struct {
+    int ndjson;           // records are JSON objects, one per line
+    int first_record;     // the next record is the file's first (maybe the CSV header)
+    int skip_duplicates;  // drop rows whose key is in keys
+    ReviewKeySet keys;
+    int added;
+    int invalid;          // records that fail the Add Review checks
+    int duplicates;
+} ImportRun;
+
+// State of run_batch()
+typedef struct {
+    FILE *out;            // answers, flushed at every commit
+    int commands;         // commands since the last commit
+    int changed;          // the table changed since it was last saved
+    int errors;           // failed commands, the exit status is 1 if any
+    char *row_text;       // scratch for batch_put_rows()
+    size_t row_capacity;
+} BatchRun;
+
+// Piece of the CSV one thread parses (see load_rows_parallel), with the
+// rows it found so far in its own columns
+typedef struct {
+    char *begin;
+    char *end;
+    char **names;
+    uint8_t *scores;
+    int32_t *date_keys;
+    char **dates;
+    char **feedbacks;
+    int count;
+    int skipped;          // rows with a score the column can't hold
+    size_t quotes;        // '"' in the piece before it is cut at a record end
+    int unclosed;         // the last record ran into the end inside quotes
+} LoadRange;
+
+// Entry of the exact name index, name == NULL marks an empty slot
+typedef struct {
+    char *name;           // pool copy of the reviewer name
+    uint32_t hash;
+    int *rows;            // rows whose name is exactly this one
+    int row_count;
+    int row_capacity;
+} NameEntry;
+
+// Entry of the date index, see day_number()
+typedef struct {
+    int32_t day;
+    int32_t row;
+} DateEntry;
+
+// Node of the BK-tree name index (see bk_add_row)
+typedef struct {
+    char *key;            // lowercase reviewer name
+    int *rows;            // review indices with this name
+    int row_count;
+    int row_capacity;
+    int edge;             // edit distance to the parent node
+    int max_child_edge;   // biggest edge below this node, bounds the search
+    int first_child;      // -1 = leaf
+    int next_sibling;     // -1 = last child
+} BKNode;
+
+// Posting list of one trigram in the partial name index
+typedef struct {
+    uint32_t gram;        // 3 bytes | TRIGRAM_USED, 0 = empty slot
+    int *nodes;           // BK node ids whose name contains the trigram
+    int count;
+    int capacity;
+} TrigramPosting;
+
+#define TRIGRAM_USED 0x1000000u
+#define MAX_PARTIAL_RESULTS 20
+#define MAX_NAME_TRIGRAMS 256
+
+// One run of the case folding table (see fold_code_point)
+typedef struct {
+    uint32_t first;
+    uint32_t last;
+    int32_t delta;
+    uint32_t stride;
+} CaseFoldRange;
+
+// Aggregates over the score column (see compute_score_stats)
+typedef struct {
+    int counts[5];        // counts[s - 1] = reviews with score s
+    int out_of_range;     // scores outside 1-5
+    long long sum;        // sum of the 1-5 scores
+    long long sum_all;    // sum of every score
+    int min_score;
+    int max_score;
+} ScoreStats;
+
 // Global variables for reviews
-Review *reviews = NULL; // Dynamic array or reviews
-int review_count = 0;
+// Columnar table: one dynamic array per field, row i is the i-th entry of each.
+// Scans only pull in the column they read (1 byte per row for scores).
+char **review_names = NULL;
+uint8_t *review_scores = NULL;
+int32_t *review_date_keys = NULL;  // date packed as YYYYMMDD, 0 = not a valid date
+char **review_dates = NULL;        // date text as entered (kept for display/save)
+char **review_feedbacks = NULL;
+int review_count = 0;  // rows, deleted ones included until compaction
 int capacity = 0;
+int skipped_rows = 0;  // rows the last load left out, see loaded_score()
 
-// Global variables for undo delete
-Review last_deleted_review;
-int has_deleted = 0;  // 0 = no deletion to undo, 1 = can undo
-int last_deleted_position = -1;  // Where it was in the array
+// Column storage: each column has its own range of address space, reserved
+// once for REVIEW_MAX_ROWS rows (PROT_NONE, no memory behind it), and the
+// table grows a block of REVIEW_BLOCK_ROWS rows at a time by opening up the
+// next block of every column in place. Rows never move, so a pointer into a
+// column stays good until free_all_memory(), and a page only costs memory
+// once a row on it is written. Without the reservation (no address space,
+// ulimit -v) the columns are heap arrays grown with realloc.
+#define REVIEW_BLOCK_ROWS 65536
+#define REVIEW_MAX_ROWS (1 << 30)
+char *review_store = NULL;  // the reservation, NULL = heap columns
+size_t review_store_size = 0;
+
+// Tombstones: bit i set = row i is deleted. Deleting only sets the bit, the
+// row (and its index entries) stay until compact_reviews() drops them all in
+// one pass. Index lookups skip dead rows, listings compact first so row
+// numbers stay 1..n.
+uint64_t *review_dead = NULL;  // (capacity + 63) / 64 words
+int dead_count = 0;
+#define COMPACT_DEAD_PERCENT 25  // compact once this share of rows is dead
+
+// Pinned rows are dead rows the undo journal can still bring back, compaction
+// keeps them (still dead) so undoing a delete only has to clear their bits
+uint64_t *review_pinned = NULL;  // same layout as review_dead
+int pinned_count = 0;
+
+// Global variables for incremental backups (see backup_reviews)
+uint64_t *review_changed = NULL;  // same layout as review_dead: bit set = row changed since the last backup
+BackupChunk *backup_chunks = NULL;  // chunks of the last backup, in row order
+int backup_chunk_count = 0;
+int backup_chunk_capacity = 0;
+int backup_rows = 0;  // rows the last backup covered
+
+// Global variables for the undo journal
+// Entries [0, undo_position) can be undone, [undo_position, undo_count) redone.
+// Any new change drops the redo side, the oldest entries go once the journal
+// holds more than undo_byte_limit (the newest entry is always kept).
+UndoEntry *undo_log = NULL;
+int undo_count = 0;
+int undo_capacity = 0;
+int undo_position = 0;
+size_t undo_bytes = 0;
+size_t undo_byte_limit = (size_t)16 << 20;  // REVIEW_UNDO_MB, 0 = no undo
+
+// Global variables for the write-ahead log (see wal_commit)
+// With the log on, every change is appended to <CSV>.wal as it happens and
+// only a checkpoint rewrites the CSV itself.
+int use_wal = 1;                // REVIEW_WAL, 0 = only Save & Exit writes anything
+int32_t *review_ids = NULL;     // column: id of the row in the log, -1 = not in it
+int32_t next_review_id = 0;     // ids count rows in the CSV, then rows added since
+int wal_fd = -1;
+char wal_path[512];
+char wal_base[256];             // the CSV the log belongs to
+uint64_t wal_base_size = 0;
+off_t wal_size = 0;             // bytes in the log file
+int wal_unsynced = 0;           // 1 = bytes written since the last fdatasync
+off_t wal_replay_end = 0;       // end of the last good record replay found, 0 = no log
+char *wal_buffer = NULL;        // records waiting for the next commit
+size_t wal_buffer_used = 0;
+size_t wal_buffer_capacity = 0;
+size_t wal_record_start = 0;    // offset of the record being built
+
+#define WAL_FLUSH_BYTES (1 << 20)       // write (not sync) a group this big right away
+#define WAL_CHECKPOINT_BYTES (1 << 20)  // no checkpoint for a log smaller than this
+#define WAL_CHECKPOINT_RATIO 4          // checkpoint once the log is 1/4 of the CSV
+
+// Global variables for the zero-copy loader
+// When reviews.csv (or its snapshot) is mmapped, review strings point
+// straight into the mapping
+int use_mmap_loader = 1;  // 1 = mmap the CSV, 0 = read it line by line
+int use_snapshot = 1;     // 1 = load <CSV>.snap when it is current
+char *mapped_csv = NULL;
+size_t mapped_csv_size = 0;
+
+// Global variables for the exact name index (see name_lookup)
+NameEntry *name_table = NULL;  // size is a power of 2
+int name_table_size = 0;
+int name_table_used = 0;
+int name_index_built = 0;  // 0 = not built yet, exact lookups build it on first use
+
+// Global variables for the date index (sorted by day, then row)
+DateEntry *date_index = NULL;
+int date_index_count = 0;
+int date_index_capacity = 0;
+int date_index_built = 0;  // 0 = not built yet, date searches build it on first use
+
+// Global variables for the name index (BK-tree, node 0 is the root)
+BKNode *bk_nodes = NULL;
+int bk_node_count = 0;
+int bk_node_capacity = 0;
+int bk_built = 0;  // 0 = not built yet, searches build it on first use
+
+// Global variables for the partial name index (trigram -> BK nodes)
+TrigramPosting *tri_table = NULL;  // open addressing, size is a power of 2
+int tri_table_size = 0;
+int tri_table_used = 0;
+uint16_t *tri_overlap = NULL;      // shared trigram count per BK node during a query
+int tri_overlap_size = 0;
+int tri_built = 0;
+
+// Global variables for the search thread pool (see workers_run)
+int search_threads = 0;  // REVIEW_THREADS, 0 = one per online CPU, 1 = no pool
+pthread_t *worker_threads = NULL;
+int worker_count = 0;     // including the thread that runs the job, 0 = not started
+pthread_mutex_t workers_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t workers_wake = PTHREAD_COND_INITIALIZER;
+pthread_cond_t workers_done = PTHREAD_COND_INITIALIZER;
+void (*workers_job)(int task, int worker, void *arg) = NULL;
+void *workers_job_arg = NULL;
+int workers_task_count = 0;
+int workers_next_task = 0;
+int workers_active = 0;   // workers still busy with the current job
+unsigned workers_generation = 0;
+int workers_stopping = 0;
+
+#define MAX_SEARCH_THREADS 64
+#define PARALLEL_MIN_NODES 4096  // smaller trees are searched on one thread
+#define TASKS_PER_THREAD 16
+#define PARALLEL_LOAD_MIN_BYTES (4 * 1024 * 1024)  // smaller CSVs are parsed on one thread
+#define CSV_FIELDS 4  // name, score, date, feedback (the last one takes the rest of the record)
+#define CSV_BLOCK 64  // bytes per csv_block_bits() scan
+#define CSV_WRITE_BUFFER (1 << 20)  // bytes save_reviews_to_csv() hands to one write()
+#define SEARCH_SCREEN_RESULTS 20  // matches listed by the search and delete menus
+
+// bk_visit() results besides a distance
+#define BK_PRUNED -1   // no child of the node can match
+#define BK_STOPPED -2  // the callback asked to stop
+
+// Scratch for editDistanceWithin(), reused by every call on the same thread
+_Thread_local uint64_t *myers_peq = NULL;  // match masks, 256 characters x blocks
+_Thread_local uint64_t *myers_pv = NULL;   // vertical +1 deltas per block
+_Thread_local uint64_t *myers_mv = NULL;   // vertical -1 deltas per block
+_Thread_local int myers_capacity = 0;      // blocks of 64 pattern characters
+
+// Scratch for partialDistanceWithin(): three table columns
+_Thread_local int *partial_rows = NULL;
+_Thread_local int partial_capacity = 0;    // entries per column
+
+// String pool behind allocate_string()
+// Strings are bump-allocated from big slabs, rounded to 8 byte size classes.
+// Released strings go to a free list per class, teardown drops whole slabs.
+#define POOL_SLAB_SIZE (1024 * 1024)
+#define POOL_CLASS_SIZE 8
+#define POOL_CLASS_COUNT 32  // free lists for strings up to 256 bytes
+
+typedef struct PoolSlab {
+    struct PoolSlab *next;
+    size_t size;
+    size_t used;
+    char data[];
+} PoolSlab;
+
+PoolSlab *pool_slabs = NULL;  // newest slab first, we bump from this one
+char *pool_free_lists[POOL_CLASS_COUNT];  // each free block stores the next pointer
 
 // === function prototypes
 void initialize_system();
 void free_all_memory();
 int load_reviews_from_csv(const char *filename);
+int load_reviews_stream(const char *filename);
+int load_reviews_mmap(const char *filename);
+void store_loaded_review(char *line, int copy_strings);
+void store_review_fields(char **fields, int copy_strings);
+int split_review_line(char *line, char **fields);
+char* map_csv_file(int fd, size_t size);
+int read_csv_records(const char *filename, ManifestLoad *load);
+int load_rows_parallel(char *begin, char *end, int threads);
+void count_quotes_task(int task, int worker, void *arg);
+void load_range_task(int task, int worker, void *arg);
+uint64_t csv_block_bits(const char *p, size_t available);
+size_t csv_count_quotes(const char *p, const char *end);
+void csv_reader_init(CsvReader *reader, char *begin, char *end);
+char* csv_next_structural(CsvReader *reader, char *from);
+int csv_read_record(CsvReader *reader, char **fields, int max_fields);
+int csv_read_review(CsvReader *reader, char **fields);
+void csv_cut_field(char *out, char *segment, char *stop);
+char* csv_find_record_end(char *p, char *end, CsvScanState *state);
+size_t csv_row_bound(int row);
+char* csv_put_row(char *dst, int row);
+char* csv_put_field(char *dst, const char *field);
+void csv_writer_reserve(CsvWriter *writer, size_t bytes);
+void csv_writer_flush(CsvWriter *writer);
+int fsync_parent_dir(const char *path);
+int wal_replay(const char *filename);
+int wal_open(const char *filename);
+int wal_reset();
+int wal_checkpoint();
+int wal_commit();
+int wal_flush();
+int wal_fall_back();
+void wal_close();
+uint32_t wal_checksum(const char *data, size_t length);
+void wal_reserve(size_t bytes);
+void wal_put(const void *data, size_t length);
+void wal_put_string(const char *str);
+void wal_put_review(int row);
+void wal_begin_record(WalRecordType type);
+void wal_end_record();
+void wal_log_add(int row);
+void wal_log_update(int row);
+void wal_log_delete(const int *rows, int count);
+void wal_log_revive(const int *rows, int count);
+int wal_get(const char **cursor, const char *end, void *out, size_t length);
+const char* wal_get_string(const char **cursor, const char *end);
+int compare_rows(const void *a, const void *b);
+int load_reviews_snapshot(const char *filename);
+int save_snapshot(const char *csv_filename);
+int snapshot_write(FILE *file, const void *data, size_t length, SnapBlock *block);
+int file_stamp(const char *path, FileStamp *stamp);
+uint32_t crc32c(uint32_t crc, const void *data, size_t length);
+uint32_t crc32c_table(uint32_t crc, const void *data, size_t length);
+#if defined(__x86_64__)
+uint32_t crc32c_sse42(uint32_t crc, const void *data, size_t length);
+#endif
+void permute_review_rows(const int *order);
+void append_review(char *name, int score, char *date, char *feedback);
+void kill_review_row(int index);
+void revive_review_row(int index);
+int is_review_live(int index);
+int is_review_pinned(int index);
+void set_review_pinned(int index, int pinned);
+int live_review_count();
+int live_rank(int index);
+int row_of_live_rank(int rank);
+void compact_reviews();
+void maybe_compact_reviews();
+void compute_live_score_stats(ScoreStats *stats);
+void merge_score_stats(ScoreStats *total, const ScoreStats *part);
+int next_row_in_state(int from, int dead);
+void release_review(Review review);
+Review get_review(int index);
+char* set_review_name(int index, char *name);
+int set_review_score(int index, int score);
+char* set_review_date(int index, char *date);
+char* set_review_feedback(int index, char *feedback);
+uint8_t pack_score(int score);
+int loaded_score(const char *text);
+void report_skipped_rows();
+int32_t pack_date(const char *date_str);
 int save_reviews_to_csv(const char *filename);
 void createSampleCSV();
 void add_review();
+void add_review_row(char *name, int score, char *date, char *feedback);
 void display_all_reviews();
 void update_review();
 void display_full_review(int index);
 void enhanced_search_menu();
 void search_reviews();
 SearchResult* searchWithTypoCorrection(const char* query, int* resultCount, int maxDistance);
+SearchResult* searchWithTypoCorrectionTopK(const char* query, int* resultCount, int maxDistance, int limit, int* totalMatches);
+void searchWithTypoCorrectionEach(const char* query, int maxDistance, SearchCallback callback, void *context);
+uint32_t hash_name(const char *name);
+NameEntry* name_lookup(const char *name, int create);
+void name_grow_table();
+void name_index_build();
+void name_index_add_row(const char *name, int row);
+void name_index_remove_row(const char *name, int row);
+void name_index_remap_rows(const int *new_row);
+const int* find_rows_by_name(const char *name, int *count);
+void name_index_free();
+int32_t day_number(int32_t packed_date);
+void date_index_build();
+int compare_date_entries(const void *a, const void *b);
+int date_index_lower_bound(int32_t day, int row);
+void date_index_add_row(int row);
+void date_index_remove_row(int row);
+void date_index_remap_rows(const int *new_row);
+int find_reviews_in_date_range(int32_t first_day, int32_t last_day, int *start);
+void date_index_free();
+void search_by_date_range();
+int32_t today_day_number();
+void bk_build();
+void bk_reorder();
+void bk_add_row(const char *name, int row);
+void bk_remove_row(const char *name, int row);
+int bk_find_node(const char *name);
+void bk_remap_rows(const int *new_row);
+int bk_visit(int node, const char *lower_query, int maxDistance, SearchCallback emit, void *context);
+int bk_search(int node, const char *lower_query, int maxDistance, SearchCallback emit, void *context);
+void bk_search_parallel(const char *lower_query, int maxDistance, int threads, ResultBuffer *out);
+void bk_search_task(int task, int worker, void *arg);
+int offer_result(int index, int distance, void *context);
+void result_heap_down(ResultBuffer *out, int slot);
+int search_thread_count();
+int workers_start(int threads);
+void* worker_main(void *arg);
+void workers_drain(int worker);
+void workers_run(void (*job)(int task, int worker, void *arg), void *arg, int task_count);
+void workers_stop();
+void bk_free();
+int compare_search_results(const void *a, const void *b);
 void enhanced_delete_menu();
 void delete_review_by_name();
 void delete_by_selection();
 void delete_all_by_user();
+int delete_reviews_by_name(const char *name);
 void delete_review_at_index(int index);
 void show_statistics();
+void compute_score_stats(const uint8_t *scores, int count, ScoreStats *stats);
+void score_stats_scalar(const uint8_t *scores, int count, ScoreStats *stats);
+#if SCORE_STATS_X86
+void score_stats_sse2(const uint8_t *scores, int count, ScoreStats *stats);
+void score_stats_avx2(const uint8_t *scores, int count, ScoreStats *stats);
+#endif
 void display_search_results(int *found_indices, int count, const char *search_term);
 void display_numbered_results(int *indices, int count);
 char* allocate_string(const char *str);
+char* allocate_folded(const char *str);
+void release_string(char *str);
+int is_mapped_string(const char *str);
+char* pool_alloc(size_t size);
+void pool_free_all();
 void resize_review_array();
+void reserve_reviews(int rows);
+int map_review_store();
+size_t column_bytes(size_t rows, size_t width);
+void commit_column(void *column, size_t width, int old_rows, int rows);
 char* toLowerCase(const char *str);
+uint32_t fold_code_point(uint32_t cp);
+void fold_case(char *dst, const char *src, size_t length);
 void trim_whitespace(char *str);
 int find_review_by_name(const char *name);
 int find_partial_matches(const char *search_term, int *found_indices, int max_results);
+int partial_tolerance(int query_length);
+int collect_trigrams(const char *text, uint32_t *grams, int max_grams, int *interior);
+TrigramPosting* tri_lookup(uint32_t gram, int create);
+void tri_grow_table();
+void tri_add_node(int node);
+void tri_build();
+void tri_free();
 int is_valid_date(const char *date_str);
 int parseScore(const char* score_str);
+const char* review_fields_error(char **fields, int *score);
 int min3(int a, int b, int c);
 int editDistance(const char* str1, const char* str2);
-int backup_reviews(const char *backup_name);
+int editDistanceWithin(const char* str1, const char* str2, int maxDistance);
+int partialDistanceWithin(const char* pattern, const char* text, int maxDistance);
+int myers_block(uint64_t *pv, uint64_t *mv, uint64_t eq, int carry_in, uint64_t high_bit);
+int myers_grow_scratch(int blocks);
+void myers_free_scratch();
+int backup_reviews(const char *backup_name, char *manifest, size_t manifest_size);
+int backup_cut_chunk(BackupWriter *writer, int row);
+int backup_keep_chunk(BackupWriter *writer, const BackupChunk *chunk);
+void backup_list_chunk(BackupWriter *writer, const BackupChunk *chunk);
+void backup_append(BackupWriter *writer, const char *data, size_t length);
+void backup_reserve(BackupWriter *writer, size_t bytes);
+void chunk_name(const char *data, size_t length, char *name, size_t name_size);
+size_t chunk_compress(const char *src, size_t length, char *dst);
+size_t chunk_bound(size_t length);
+int chunk_decompress(const char *ext, const char *src, size_t packed, char *dst, size_t length);
+size_t lz_compress(const unsigned char *src, size_t length, unsigned char *dst);
+size_t lz_sequence(unsigned char *dst, size_t out, const unsigned char *literals, size_t literal_count,
+                   size_t offset, size_t match);
+int lz_decompress(const unsigned char *src, size_t packed, unsigned char *dst, size_t length);
+void mark_row_changed(int index);
+int any_row_changed(int from, int to);
+void backup_remap_rows(const int *new_row);
+void backup_drop_row(int row);
+void backup_forget();
+int manifest_read_chunks(const char *manifest_path, int verify, ChunkCallback visit, void *context);
+int load_reviews_manifest(const char *manifest_path);
+void load_chunk_rows(char *text, size_t length, void *context);
+void load_manifest_line(ManifestLoad *load, char *line);
+int is_backup_manifest(const char *filename);
+void stream_report_menu();
+int stream_report(const char *filename, StreamReport *report);
+void stream_report_line(char *line, void *context);
+int stream_name_matches(StreamReport *report, const char *name);
+void print_stream_report(const StreamReport *report);
+void import_menu();
+int import_reviews(const char *filename, int skip_duplicates, ImportRun *run);
+long long count_import_records(const char *filename, int manifest);
+void count_chunk_lines(char *text, size_t length, void *context);
+void import_record(char *line, void *context);
+int is_ndjson_file(const char *filename);
+int parse_ndjson_review(char *line, char **fields);
+char* json_skip_space(char *p);
+char* json_read_string(char *p, char **value);
+int json_hex4(const char *p, uint32_t *value);
+char* json_skip_value(char *p);
+uint32_t review_key_hash(const char *name, const char *date, const char *feedback);
+void key_set_init(ReviewKeySet *set, size_t keys);
+int key_set_add(ReviewKeySet *set, int row, const char *name, const char *date, const char *feedback);
+void key_set_free(ReviewKeySet *set);
+int run_batch(const char *script);
+ssize_t batch_read_command(FILE *in, char **line, size_t *capacity);
+void batch_execute(BatchRun *run, char *line);
+void batch_add(BatchRun *run, char *args);
+void batch_import(BatchRun *run, char *args, int skip_duplicates);
+void batch_query(BatchRun *run, char *args);
+void batch_delete(BatchRun *run, char *args);
+void batch_stats(BatchRun *run);
+void batch_save(BatchRun *run);
+void batch_backup(BatchRun *run, char *args);
+int batch_commit(BatchRun *run);
+void batch_put_rows(BatchRun *run, const int *rows, int count);
+void batch_error(BatchRun *run, const char *message);
 int restore_from_backup(const char *filename);
-void undo_last_delete();
+void undo_record(UndoKind kind, const int *rows, int row_count, Review swap);
+void undo_drop_entry(UndoEntry *entry, int applied);
+void undo_trim();
+void undo_remap_rows(const int *new_row);
+void undo_clear();
+size_t review_bytes(int row);
+void undo_apply(UndoEntry *entry, int forward);
+void undo_last_change();
+void redo_last_change();
+
+int main(int argc, char *argv[]) {
+    // review_system --exec <script>: run commands instead of the menus
+    if (argc == 3 && strcmp(argv[1], "--exec") == 0) {
+        return run_batch(argv[2]);
+    }
+    if (argc != 1) {
+        fprintf(stderr, "Usage: %s [--exec <script file, - = stdin>]\n", argv[0]);
+        return 2;
+    }
 
-int main() {
     printf("=== Customer Review Management System ===\n");
 
     initialize_system();
@@ -73,6 +806,9 @@ int main() {
     } else {
         printf("Starting with nothing\n");
     }
+    if (use_wal) {
+        wal_open("reviews.csv");
+    }
 
     int choice;
     do {
@@ -86,9 +822,10 @@ int main() {
         printf("5. Delete Review\n");
         printf("6. Statistics\n");
         printf("7. Backup/Restore\n");
-        printf("8. Undo Last Delete\n");
+        printf("8. Undo Last Change\n");
         printf("9. Save & Exit\n");
-        printf("Enter choice (1-9): ");
+        printf("10. Redo Last Undo\n");
+        printf("Enter choice (1-10): ");
 
         if (scanf("%d", &choice) != 1) {
             int c;
@@ -120,33 +857,54 @@ int main() {
                 show_statistics();
                 break;
             case 7: {
-                printf("\n1. Create Backup\n2. Restore Backup\nChoice: ");
+                printf("\n1. Create Backup\n2. Restore Backup\n3. Report on a File (streaming)\n4. Import/Merge a File\nChoice: ");
                 int backup_choice;
                 scanf("%d", &backup_choice);
                 getchar();
                 if (backup_choice == 1) {
-                    backup_reviews(NULL);
+                    backup_reviews(NULL, NULL, 0);
                 } else if (backup_choice == 2) {
                     char filename[256];
                     printf("Enter backup filename: ");
                     fgets(filename, sizeof(filename), stdin);
                     filename[strcspn(filename, "\n")] = 0;
                     restore_from_backup(filename);
+                } else if (backup_choice == 3) {
+                    stream_report_menu();
+                } else if (backup_choice == 4) {
+                    import_menu();
                 }
                 break;
             }
             case 8:
-                undo_last_delete();
+                undo_last_change();
+                break;
+            case 9: {
+                int saved;
+                if (wal_fd >= 0) {
+                    saved = wal_checkpoint();
+                } else if ((saved = save_reviews_to_csv("reviews.csv")) == 0) {
+                    save_snapshot("reviews.csv");
+                }
+                if (saved == 0) {
+                    printf("✅ Data saved successfully!\n");
+                } else {
+                    printf("❌ Failed to save data!\n");
+                }
                 break;
-            case 9:
-                save_reviews_to_csv("reviews.csv");
-                printf("✅ Data saved successfully!\n");
+            }
+            case 10:
+                redo_last_change();
                 break;
             default:
                 printf("❌ Invalid choice!\n");
         }
+        if (wal_commit() != 0) {  // one sync for whatever the action changed
+            printf("❌ Failed to save data!\n");
+        }
     } while (choice != 9);
 
+    wal_close();
     free_all_memory();
     printf("Bye\n");
     return 0;
@@ -155,28 +913,87 @@ int main() {
 // Function
 // core system
 void initialize_system() {
-    capacity = 5;  // Start with capacity for 5 reviews
-    reviews = (Review*)malloc(capacity * sizeof(Review));
-    if (!reviews) {
+    if (map_review_store()) {
+        capacity = 0;
+        reserve_reviews(1);  // the first block
+    } else {
+        capacity = 5;  // Start with capacity for 5 reviews
+        review_names = (char**)malloc(capacity * sizeof(char*));
+        review_scores = (uint8_t*)malloc(capacity * sizeof(uint8_t));
+        review_date_keys = (int32_t*)malloc(capacity * sizeof(int32_t));
+        review_dates = (char**)malloc(capacity * sizeof(char*));
+        review_feedbacks = (char**)malloc(capacity * sizeof(char*));
+        review_dead = (uint64_t*)calloc((capacity + 63) / 64, sizeof(uint64_t));
+        review_pinned = (uint64_t*)calloc((capacity + 63) / 64, sizeof(uint64_t));
+        review_changed = (uint64_t*)calloc((capacity + 63) / 64, sizeof(uint64_t));
+        review_ids = (int32_t*)malloc(capacity * sizeof(int32_t));
+    }
+    if (!review_names || !review_scores || !review_date_keys || !review_dates || !review_feedbacks || !review_dead || !review_pinned || !review_changed || !review_ids) {
         printf("Memory allocation failed!\n");
         exit(1);
     }
     review_count = 0;
+    dead_count = 0;
+    pinned_count = 0;
+    next_review_id = 0;
+
+    const char *threads = getenv("REVIEW_THREADS");
+    if (threads) {
+        search_threads = atoi(threads);
+        if (search_threads < 0) search_threads = 0;
+        if (search_threads > MAX_SEARCH_THREADS) search_threads = MAX_SEARCH_THREADS;
+    }
+
+    const char *undo_mb = getenv("REVIEW_UNDO_MB");
+    if (undo_mb) {
+        long mb = atol(undo_mb);
+        undo_byte_limit = mb > 0 ? (size_t)mb << 20 : 0;
+    }
+
+    const char *wal = getenv("REVIEW_WAL");
+    if (wal) use_wal = atoi(wal) != 0;
 }
 
 void free_all_memory() {
-    for (int i = 0; i < review_count; i++) {
-        free(reviews[i].reviewer_name);
-        free(reviews[i].review_date);
-        free(reviews[i].feedback);
+    // Every review string (the undo journal's included) lives in the string
+    // pool or the CSV mapping, so there is nothing to free one by one
+    undo_clear();
+    backup_forget();
+    if (review_store) {
+        munmap(review_store, review_store_size);
+        review_store = NULL;
+    } else {
+        free(review_names);
+        free(review_scores);
+        free(review_date_keys);
+        free(review_dates);
+        free(review_feedbacks);
+        free(review_dead);
+        free(review_pinned);
+        free(review_changed);
+        free(review_ids);
     }
-    free(reviews);
-    
-    // Clean up undo memory if exists
-    if (has_deleted) {
-        free(last_deleted_review.reviewer_name);
-        free(last_deleted_review.review_date);
-        free(last_deleted_review.feedback);
+    capacity = 0;
+    review_names = review_dates = review_feedbacks = NULL;
+    review_scores = NULL;
+    review_date_keys = review_ids = NULL;
+    review_dead = review_pinned = review_changed = NULL;
+    review_count = 0;
+    dead_count = 0;
+    pinned_count = 0;
+    next_review_id = 0;
+    name_index_free();
+    date_index_free();
+    bk_free();
+    workers_stop();
+    pool_free_all();
+    myers_free_scratch();
+
+    // Drop the CSV mapping last, nothing points into it anymore
+    if (mapped_csv) {
+        munmap(mapped_csv, mapped_csv_size);
+        mapped_csv = NULL;
+        mapped_csv_size = 0;
     }
     
     printf("Memory cleaned up successfully\n");
@@ -184,1039 +1001,5906 @@ void free_all_memory() {
 
 // file I/O
 int load_reviews_from_csv(const char *filename) {
+    int result = -2;
+    skipped_rows = 0;
+    if (use_snapshot) {
+        result = load_reviews_snapshot(filename);
+    }
+    // Only one file can be mapped at a time (restore unmaps before reloading)
+    if (result == -2 && use_mmap_loader && !mapped_csv) {
+        result = load_reviews_mmap(filename);
+    }
+    if (result == -2) {
+        // -2 = could not map (pipe, empty file, ...) so read it the old way
+        result = load_reviews_stream(filename);
+    }
+    report_skipped_rows();
+
+    // Changes logged since the last checkpoint go on top
+    if (use_wal && wal_replay(filename) > 0) {
+        result = 0;
+    }
+    return result;
+}
+
+// Read the file in blocks, records are put back together across the block
+// borders by load_chunk_rows() whatever their length
+int load_reviews_stream(const char *filename) {
+    ManifestLoad load;
+    memset(&load, 0, sizeof(load));
+    load.skip_header = 1;
+    int result = read_csv_records(filename, &load);
+    if (result == 0 && load.partial_size > 0) {
+        load_manifest_line(&load, load.partial);  // last record had no '\n'
+    }
+    free(load.partial);
+    return result;
+}
+
+// Feed every record of a CSV file to load, a STREAM_BLOCK_SIZE block at a
+// time. The caller handles load->partial (a last record without '\n').
+// Returns -1 if the file is missing or cannot be read, 1 if it is empty.
+int read_csv_records(const char *filename, ManifestLoad *load) {
     FILE *file = fopen(filename, "r");
     if (!file) {
         return -1;
     }
+    posix_fadvise(fileno(file), 0, 0, POSIX_FADV_SEQUENTIAL);
+    char *block = malloc(STREAM_BLOCK_SIZE);
+    if (!block) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
 
-    char line[1024]; // Prepare to collect header and never use it again
+    size_t length, total = 0;
+    while ((length = fread(block, 1, STREAM_BLOCK_SIZE, file)) > 0) {
+        load_chunk_rows(block, length, load);
+        total += length;
+    }
+    int result = ferror(file) ? -1 : total == 0 ? 1 : 0;
+    free(block);
+    fclose(file);
+    return result;
+}
 
-    // Skip header line
-    if (fgets(line, sizeof(line), file) == NULL) { // read one line, put it in the variable named "line"
-        fclose(file);
+/**
+ * Zero-copy loader: map the whole file and let every review field point into it.
+ * The mapping is MAP_PRIVATE so we can cut records and fields in place with '\0'
+ * (the file on disk is never touched). Strings are only copied later when
+ * add/update replaces them, see release_string().
+ * Returns 0 on success, -1 if the file is missing/empty, -2 if it can't be mapped.
+ */
+int load_reviews_mmap(const char *filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
         return -1;
     }
 
-    while (fgets(line, sizeof(line), file)) {
-        line[strcspn(line, "\n")] = 0;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        close(fd);
+        return -2;
+    }
 
-        // Parse csv line and handle commas in feedback
-        char *reviewer_name = strtok(line, ",");
-        char *score_str = strtok(NULL, ",");
-        char *review_date = strtok(NULL, ",");
-        char *feedback = strtok(NULL, ""); // Get the rest, No more commas errors or syntax errors
-        if (reviewer_name && score_str && review_date && feedback) {
-            if (review_count >= capacity) {
-                resize_review_array();
-            }
+    size_t size = (size_t)st.st_size;
+    char *data = map_csv_file(fd, size);
+    if (data == MAP_FAILED) {
+        close(fd);
+        return -2;
+    }
 
-            // Remove leading space from feedback
-            while (*feedback == ' ') feedback++;
+    mapped_csv = data;
+    mapped_csv_size = size + 1;
 
-            // Allocate memory and copy data (This part is complex)
-            // Array_name[index]
-            reviews[review_count].reviewer_name = allocate_string(reviewer_name);
-            reviews[review_count].satisfaction_score = atoi(score_str);
-            reviews[review_count].review_date = allocate_string(review_date);
-            reviews[review_count].feedback = allocate_string(feedback);
-            review_count++;
+    CsvReader reader;
+    char *fields[CSV_FIELDS];
+    csv_reader_init(&reader, data, data + size);
+    csv_read_record(&reader, fields, CSV_FIELDS);  // Skip header line
+
+    // Big files are parsed on every core
+    int threads = search_thread_count();
+    if (threads > 1 && (size_t)(reader.end - reader.next) >= PARALLEL_LOAD_MIN_BYTES) {
+        if (load_rows_parallel(reader.next, reader.end, threads) == 0) {
+            close(fd);
+            return 0;
+        }
+        // Stray quotes the cut points could not see, and the pieces have cut
+        // their fields in place by now: map the file again, read it in one go
+        munmap(data, size + 1);
+        data = map_csv_file(fd, size);
+        if (data == MAP_FAILED) {
+            mapped_csv = NULL;
+            mapped_csv_size = 0;
+            close(fd);
+            return -2;
         }
+        mapped_csv = data;
+        csv_reader_init(&reader, data, data + size);
+        csv_read_record(&reader, fields, CSV_FIELDS);
     }
+    close(fd);
 
-    fclose(file);
+    int got;
+    while ((got = csv_read_review(&reader, fields)) >= 0) {
+        if (got) store_review_fields(fields, 0);
+    }
     return 0;
 }
 
-int save_reviews_to_csv(const char *filename) {
-    FILE *file = fopen(filename, "w");
-    if (!file) {
-        printf("Cannot create/open file for writing!\n");
-        return -1;
+// Map fd private and writable with one zero byte after its end, so the last
+// field can get its '\0' even when the file does not end with '\n'. The
+// spare byte is anonymous memory when the file ends on a page boundary.
+char* map_csv_file(int fd, size_t size) {
+    char *data = mmap(NULL, size + 1, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED) {
+        return data;
     }
-    
-    // Write header
-    fprintf(file, "ReviewerName,SatisfactionScore,ReviewDate,Feedback\n");
-    
-    // Write review data
-    for (int i = 0; i < review_count; i++) {
-        fprintf(file, "%s,%d,%s,%s\n", 
-                reviews[i].reviewer_name, 
-                reviews[i].satisfaction_score,
-                reviews[i].review_date,
-                reviews[i].feedback);
+    if (mmap(data, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(data, size + 1);
+        return MAP_FAILED;
     }
-    
-    fclose(file);
-    printf("Saved to reviews.csv\n");
-    return 0;
+    madvise(data, size, MADV_SEQUENTIAL);
+    return data;
 }
 
-// review operations
-void add_review() {
-    printf("\n=== Add New Review\n");
+// Split one CSV record (already without '\n') and append it to reviews
+// copy_strings = 0 keeps pointers into the line itself (mmap loader)
+void store_loaded_review(char *line, int copy_strings) {
+    char *fields[CSV_FIELDS];
+    if (!split_review_line(line, fields)) {
+        return;
+    }
+    store_review_fields(fields, copy_strings);
+}
 
-    if (review_count >= capacity) {
-        resize_review_array();
+void store_review_fields(char **fields, int copy_strings) {
+    int score = loaded_score(fields[1]);
+    if (score < 0) {
+        skipped_rows++;
+        return;
     }
+    // Allocate memory and copy data unless the line outlives us (mapped file)
+    if (copy_strings) {
+        append_review(allocate_string(fields[0]), score,
+                      allocate_string(fields[2]), allocate_string(fields[3]));
+    } else {
+        append_review(fields[0], score, fields[2], fields[3]);
+    }
+}
 
-    char temp_name[256], temp_date[50], temp_feedback[512];
-    int temp_score;
+// Cut one CSV record in place into name, score, date and feedback (the rest
+// of the record, unquoted commas and all). Returns 0 if a field is missing.
+// Safe on any thread.
+int split_review_line(char *line, char **fields) {
+    CsvReader reader;
+    csv_reader_init(&reader, line, line + strlen(line));
+    return csv_read_review(&reader, fields) == 1;
+}
 
-    printf("Enter reviewer name: ");
-    fgets(temp_name, sizeof(temp_name), stdin);
-    temp_name[strcspn(temp_name, "\n")] = 0;
+/**
+ * Parse the records in [begin, end) of the mapped CSV on the thread pool.
+ * The range is cut into pieces that start right after a record's '\n', each
+ * piece is parsed into its own staging columns, then the pieces are copied
+ * into the table in file order, so the rows come out exactly as one thread
+ * would have loaded them.
+ * A '\n' inside a quoted field does not end a record, so the cuts need the
+ * quote state: every quote flips it, so it is the parity of the quotes
+ * before the cut, counted in parallel first (as simdcsv does). That only
+ * holds for RFC 4180 files. Returns -1 without loading anything if a piece
+ * ends inside quotes (a stray '"' in an unquoted field), the caller then
+ * reads the file on one thread.
+ */
+int load_rows_parallel(char *begin, char *end, int threads) {
+    threads = workers_start(threads);
+    int tasks = threads * TASKS_PER_THREAD;
+    LoadRange *ranges = calloc(tasks, sizeof(LoadRange));
+    if (!ranges) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
 
-    while (strlen(temp_name) == 0 || strlen(temp_name) > 50) {
-        if (strlen(temp_name) == 0) {
-            printf("Name cannot be empty! ");
-        } else {
-            printf("Name too long (max 50 characters)! ");
+    size_t size = end - begin;
+    for (int t = 0; t < tasks; t++) {
+        ranges[t].begin = begin + size / tasks * t;
+        ranges[t].end = t == tasks - 1 ? end : begin + size / tasks * (t + 1);
+    }
+    workers_run(count_quotes_task, ranges, tasks);
+
+    // Move each cut to the end of the record it falls in. A piece is
+    // parsed up to its last '\n' (its own byte, the reader puts a '\0'
+    // there), the last one up to the spare byte after the mapping.
+    int in_quotes = 0;
+    char *start = begin;
+    for (int t = 0; t < tasks; t++) {
+        char *cut = ranges[t].end;
+        ranges[t].begin = start;
+        if (t == tasks - 1) {
+            ranges[t].end = end;
+            break;
         }
-        printf("Enter reviewer name: ");
-        fgets(temp_name, sizeof(temp_name), stdin);
-        temp_name[strcspn(temp_name, "\n")] = 0;
+        in_quotes ^= ranges[t].quotes & 1;
+        int quoted = in_quotes;
+        while (cut < end && (*cut != '\n' || quoted)) {
+            if (*cut == '"') quoted ^= 1;
+            cut++;
+        }
+        cut = cut < end ? cut + 1 : end;
+        if (cut < start) cut = start;
+        ranges[t].end = cut == end || cut == start ? cut : cut - 1;
+        start = cut;
     }
 
-    do {
-        printf("Enter satisfaction score (1-5): ");
-        int result = scanf("%d", &temp_score);
-        if (result != 1) {
-            printf("Invalid input! Enter number instead\n");
+    workers_run(load_range_task, ranges, tasks);
 
-            int c;
-            while ((c = getchar()) != '\n' && c != EOF);
+    int broken = 0;
+    for (int t = 0; t < tasks; t++) {
+        if (ranges[t].unclosed && ranges[t].end != end) broken = 1;
+    }
 
-            temp_score = 0;
-        } else if (temp_score < 1 || temp_score > 5) {
-            printf("Please enter a score between 1 to 5\n");
+    if (!broken) {
+        int rows = 0;
+        for (int t = 0; t < tasks; t++) {
+            rows += ranges[t].count;
+            skipped_rows += ranges[t].skipped;
         }
-    } while (temp_score < 1 || temp_score > 5);
+        reserve_reviews(review_count + rows);
+    }
+    for (int t = 0; t < tasks; t++) {
+        LoadRange *range = &ranges[t];
+        if (!broken) {
+            memcpy(review_names + review_count, range->names, range->count * sizeof(char*));
+            memcpy(review_scores + review_count, range->scores, range->count * sizeof(uint8_t));
+            memcpy(review_date_keys + review_count, range->date_keys, range->count * sizeof(int32_t));
+            memcpy(review_dates + review_count, range->dates, range->count * sizeof(char*));
+            memcpy(review_feedbacks + review_count, range->feedbacks, range->count * sizeof(char*));
+            for (int i = 0; i < range->count; i++, review_count++) {
+                review_ids[review_count] = next_review_id++;
+                if (bk_built) bk_add_row(review_names[review_count], review_count);
+                if (name_index_built) name_index_add_row(review_names[review_count], review_count);
+                if (date_index_built) date_index_add_row(review_count);
+            }
+        }
+        free(range->names);
+        free(range->scores);
+        free(range->date_keys);
+        free(range->dates);
+        free(range->feedbacks);
+    }
+    free(ranges);
+    return broken ? -1 : 0;
+}
 
-    getchar();
+// First pass of load_rows_parallel(): the quotes in one even piece
+void count_quotes_task(int task, int worker, void *arg) {
+    (void)worker;
+    LoadRange *range = &((LoadRange*)arg)[task];
+    range->quotes = csv_count_quotes(range->begin, range->end);
+}
 
-    printf("Enter review date (YYYY-MM-DD): ");
-    fgets(temp_date, sizeof(temp_date), stdin);
-    temp_date[strcspn(temp_date, "\n")] = 0; // Remove newline
+// One piece of load_rows_parallel(), it starts at a record
+void load_range_task(int task, int worker, void *arg) {
+    (void)worker;
+    LoadRange *range = &((LoadRange*)arg)[task];
+    int capacity = (range->end - range->begin) / 48 + 16;  // a guess, grown as needed
+    range->names = malloc(capacity * sizeof(char*));
+    range->scores = malloc(capacity * sizeof(uint8_t));
+    range->date_keys = malloc(capacity * sizeof(int32_t));
+    range->dates = malloc(capacity * sizeof(char*));
+    range->feedbacks = malloc(capacity * sizeof(char*));
 
-    while (!is_valid_date(temp_date)) {
-        printf("Invalid date format! Use YYYY-MM-DD: ");
-        fgets(temp_date, sizeof(temp_date), stdin);
-        temp_date[strcspn(temp_date, "\n")] = 0;
+    CsvReader reader;
+    csv_reader_init(&reader, range->begin, range->end);
+    char *fields[CSV_FIELDS];
+    int got;
+    while ((got = csv_read_review(&reader, fields)) >= 0) {
+        if (!got) continue;
+        int score = loaded_score(fields[1]);
+        if (score < 0) {
+            range->skipped++;
+            continue;
+        }
+        if (range->count == capacity) {
+            capacity *= 2;
+            range->names = realloc(range->names, capacity * sizeof(char*));
+            range->scores = realloc(range->scores, capacity * sizeof(uint8_t));
+            range->date_keys = realloc(range->date_keys, capacity * sizeof(int32_t));
+            range->dates = realloc(range->dates, capacity * sizeof(char*));
+            range->feedbacks = realloc(range->feedbacks, capacity * sizeof(char*));
+        }
+        if (!range->names || !range->scores || !range->date_keys || !range->dates || !range->feedbacks) {
+            printf("Memory allocation failed!\n");
+            exit(1);
+        }
+        range->names[range->count] = fields[0];
+        range->scores[range->count] = (uint8_t)score;
+        range->date_keys[range->count] = pack_date(fields[2]);
+        range->dates[range->count] = fields[2];
+        range->feedbacks[range->count] = fields[3];
+        range->count++;
     }
+    range->unclosed = reader.unclosed;
+}
 
-    printf("Enter feedback: ");
-    fgets(temp_feedback, sizeof(temp_feedback), stdin);
-    temp_feedback[strcspn(temp_feedback, "\n")] = 0;
+// CSV (RFC 4180)
+// Fields are split by ',' and records by '\n' ("\r\n" works too). A field
+// that starts with '"' runs to the closing '"' and may hold ',', line breaks
+// and doubled quotes (""). A quote anywhere else is plain text. The feedback
+// is the last field and keeps any unquoted commas after it, as in files
+// written before fields were quoted.
+// The scanner looks at 64 bytes at a time: SSE2 compares give one bit per
+// ',', '"' and '\n' and only those bytes are visited, everything between
+// them is skipped.
 
-    while (strlen(temp_feedback) > 200) {
-        printf("Feedback too long! Max 200 characters. Try again: ");
-        fgets(temp_feedback, sizeof(temp_feedback), stdin);
-        temp_feedback[strcspn(temp_feedback, "\n")] = 0;
+// Bits of the ',', '"' and '\n' among the 64 bytes at p (available says how
+// many are there, the rest counts as plain text)
+uint64_t csv_block_bits(const char *p, size_t available) {
+    char padded[CSV_BLOCK];
+    if (available < CSV_BLOCK) {
+        memset(padded, 0, sizeof(padded));
+        memcpy(padded, p, available);
+        p = padded;
     }
 
-    reviews[review_count].reviewer_name = allocate_string(temp_name);
-    reviews[review_count].satisfaction_score = temp_score;
-    reviews[review_count].review_date = allocate_string(temp_date);
-    reviews[review_count].feedback = allocate_string(temp_feedback);
-    review_count++;
-    printf("Review added!! yay\n");
+    uint64_t bits = 0;
+#if CSV_SCAN_SSE2
+    const __m128i comma = _mm_set1_epi8(','), quote = _mm_set1_epi8('"'), newline = _mm_set1_epi8('\n');
+    for (int i = 0; i < CSV_BLOCK / 16; i++) {
+        __m128i bytes = _mm_loadu_si128((const __m128i*)(p + 16 * i));
+        __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, comma), _mm_cmpeq_epi8(bytes, quote)),
+                                    _mm_cmpeq_epi8(bytes, newline));
+        bits |= (uint64_t)(uint16_t)_mm_movemask_epi8(hits) << (16 * i);
+    }
+#else
+    for (int i = 0; i < CSV_BLOCK; i++) {
+        if (p[i] == ',' || p[i] == '"' || p[i] == '\n') bits |= 1ULL << i;
+    }
+#endif
+    return bits;
 }
 
-void display_all_reviews() {
-
-    printf("\n=== All Customer Reviews ===\n");
-
-    if (review_count == 0) {
-        printf("No reviews found.\n");
-        return;
+// Number of '"' in [p, end)
+size_t csv_count_quotes(const char *p, const char *end) {
+    size_t count = 0;
+#if CSV_SCAN_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    for (; end - p >= 16; p += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i*)p);
+        count += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, quote)));
     }
+#endif
+    for (; p < end; p++) {
+        if (*p == '"') count++;
+    }
+    return count;
+}
 
-    printf("\n=== All Customer Reviews ===\n");
-    printf("%-4s %-20s %-6s %-12s %-50s\n", "#", "Reviewer", "Score", "Date", "Feedback");
-    printf("------------------------------------------------------------------------\n");
+void csv_reader_init(CsvReader *reader, char *begin, char *end) {
+    reader->next = begin;
+    reader->end = end;
+    reader->block = NULL;
+    reader->bits = 0;
+    reader->unclosed = 0;
+}
 
-    for (int i = 0; i < review_count; i++) {
-        char display_feedback[51];
-        if(strlen(reviews[i].feedback) > 50) {
-            strncpy(display_feedback, reviews[i].feedback, 47);
-            strcpy(display_feedback + 47, "...");
-        } else {
-            strcpy(display_feedback, reviews[i].feedback);
+// Next ',', '"' or '\n' at or after from, reader->end if there is none
+char* csv_next_structural(CsvReader *reader, char *from) {
+    while (from < reader->end) {
+        if (!reader->block || from < reader->block || from >= reader->block + CSV_BLOCK) {
+            reader->block = from;
+            reader->bits = csv_block_bits(from, reader->end - from);
         }
+        uint64_t bits = reader->bits & (~0ULL << (from - reader->block));
+        if (bits) {
+            return reader->block + __builtin_ctzll(bits);
+        }
+        from = reader->block + CSV_BLOCK;
+    }
+    return reader->end;
+}
 
-        printf("%-4d %-20s %-6d %-12s %-50s\n",
-                i + 1,
-                reviews[i].reviewer_name,
-                reviews[i].satisfaction_score,
-                reviews[i].review_date,
-                display_feedback);
+/**
+ * Cut the next record into fields in place: every field gets a '\0' and
+ * quoted parts lose their quotes (the text moves left over them, so it only
+ * writes behind the scan). After max_fields - 1 commas the last field takes
+ * the rest of the record. Returns the number of fields (1 for an empty
+ * line), 0 at the end of the buffer.
+ */
+int csv_read_record(CsvReader *reader, char **fields, int max_fields) {
+    char *at = reader->next;
+    if (at >= reader->end) {
+        return 0;
     }
 
-    printf("\nTotal reviews: %d\n", review_count);
+    int count = 1;
+    fields[0] = at;
+    char *segment = at;   // text of the field not moved yet
+    char *out = NULL;     // where that text goes, NULL = the field stays in place
+    char *opens = at;     // a '"' here opens a quoted part
+    int in_quotes = 0;
+    for (;; at++) {
+        at = csv_next_structural(reader, at);
+        if (at >= reader->end) break;
 
-    if (review_count > 0) {
-        float total_score = 0;
-        for (int i = 0; i < review_count; i++) {
-            total_score += reviews[i].satisfaction_score;
+        if (in_quotes) {
+            if (*at == '"') {
+                memmove(out, segment, at - segment);
+                out += at - segment;
+                segment = opens = at + 1;  // a '"' right after is a doubled one
+                in_quotes = 0;
+            }
+        } else if (*at == '"') {
+            if (at == opens) {
+                if (out) {
+                    memmove(out, segment, at - segment);
+                    out += at - segment;
+                    *out++ = '"';
+                } else {
+                    out = at;
+                }
+                segment = at + 1;
+                in_quotes = 1;
+            }
+        } else if (*at == ',') {
+            if (count < max_fields) {
+                csv_cut_field(out, segment, at);
+                fields[count++] = segment = opens = at + 1;
+                out = NULL;
+            }
+        } else {
+            break;  // '\n'
         }
-        printf("Average satisfaction score: %.2f/5\n", total_score / review_count);
     }
+
+    reader->unclosed = in_quotes;
+    reader->next = at < reader->end ? at + 1 : reader->end;
+    char *stop = at;
+    if (!in_quotes && stop > segment && stop[-1] == '\r') stop--;
+    csv_cut_field(out, segment, stop);
+    return count;
 }
 
-void update_review() {
-    if (review_count == 0) {
-        printf("No reviews to update.\n");
-        return;
+// Next review of the buffer into fields (name, score, date, feedback).
+// Returns 1 for a review, 0 for a record that is not one, -1 at the end.
+int csv_read_review(CsvReader *reader, char **fields) {
+    int count = csv_read_record(reader, fields, CSV_FIELDS);
+    if (count == 0) {
+        return -1;
     }
-    
-    display_all_reviews();
-    
-    printf("\nEnter review number to update (1-%d): ", review_count);
-    int choice;
-    scanf("%d", &choice);
-    getchar();
-    
-    if (choice < 1 || choice > review_count) {
-        printf("Invalid choice!\n");
-        return;
+    if (count < CSV_FIELDS) {
+        return 0;
     }
-    
-    int index = choice - 1;
-    
-    printf("\n=== Updating Review #%d ===\n", choice);
-    display_full_review(index);
-    
-    printf("\nWhat do you want to update?\n");
-    printf("1. Reviewer Name\n");
-    printf("2. Satisfaction Score\n");
-    printf("3. Review Date\n");
-    printf("4. Feedback\n");
-    printf("5. Update All Fields\n");
-    printf("Choice: ");
-    
-    int update_choice;
-    scanf("%d", &update_choice);
-    getchar();
-    
-    char temp_buffer[512];
-    int temp_score;
-    
-    switch(update_choice) {
-        case 1:
-            printf("Enter new reviewer name: ");
-            fgets(temp_buffer, sizeof(temp_buffer), stdin);
-            temp_buffer[strcspn(temp_buffer, "\n")] = 0;
-            free(reviews[index].reviewer_name);
-            reviews[index].reviewer_name = allocate_string(temp_buffer);
-            printf("✅ Name updated!\n");
-            break;
-            
-        case 2:
-            do {
-                printf("Enter new satisfaction score (1-5): ");
-                scanf("%d", &temp_score);
-            } while (temp_score < 1 || temp_score > 5);
-            reviews[index].satisfaction_score = temp_score;
-            printf("✅ Score updated!\n");
-            break;
-            
-        case 3:
-            printf("Enter new review date (YYYY-MM-DD): ");
-            fgets(temp_buffer, sizeof(temp_buffer), stdin);
-            temp_buffer[strcspn(temp_buffer, "\n")] = 0;
-            free(reviews[index].review_date);
-            reviews[index].review_date = allocate_string(temp_buffer);
-            printf("✅ Date updated!\n");
-            break;
-            
-        case 4:
-            printf("Enter new feedback: ");
-            fgets(temp_buffer, sizeof(temp_buffer), stdin);
-            temp_buffer[strcspn(temp_buffer, "\n")] = 0;
-            free(reviews[index].feedback);
-            reviews[index].feedback = allocate_string(temp_buffer);
-            printf("✅ Feedback updated!\n");
-            break;
-            
-        case 5:
-            printf("Enter new reviewer name: ");
-            fgets(temp_buffer, sizeof(temp_buffer), stdin);
-            temp_buffer[strcspn(temp_buffer, "\n")] = 0;
-            free(reviews[index].reviewer_name);
-            reviews[index].reviewer_name = allocate_string(temp_buffer);
-            
-            do {
-                printf("Enter new satisfaction score (1-5): ");
-                scanf("%d", &temp_score);
-                getchar();
-            } while (temp_score < 1 || temp_score > 5);
-            reviews[index].satisfaction_score = temp_score;
-            
-            printf("Enter new review date (YYYY-MM-DD): ");
-            fgets(temp_buffer, sizeof(temp_buffer), stdin);
-            temp_buffer[strcspn(temp_buffer, "\n")] = 0;
-            free(reviews[index].review_date);
-            reviews[index].review_date = allocate_string(temp_buffer);
-            
-            printf("Enter new feedback: ");
-            fgets(temp_buffer, sizeof(temp_buffer), stdin);
-            temp_buffer[strcspn(temp_buffer, "\n")] = 0;
-            free(reviews[index].feedback);
-            reviews[index].feedback = allocate_string(temp_buffer);
-            
-            printf("✅ All fields updated!\n");
-            break;
-            
-        default:
-            printf("Invalid choice!\n");
+
+    // Remove leading space from feedback
+    while (*fields[3] == ' ') fields[3]++;
+    return 1;
+}
+
+// End a field at stop: the text from segment on goes to out and gets its
+// '\0' (out = NULL: the field was never quoted and is already in place)
+void csv_cut_field(char *out, char *segment, char *stop) {
+    if (out) {
+        memmove(out, segment, stop - segment);
+        out[stop - segment] = '\0';
+    } else {
+        *stop = '\0';
     }
 }
 
-void display_full_review(int index) {
-    if (index < 0 || index >= review_count) {
-        printf("Invalid review index!\n");
-        return;
+// The '\n' that ends the record a scan is in, NULL if the buffer ends first.
+// Reads only, state carries what the scan knows on to the next buffer.
+char* csv_find_record_end(char *p, char *end, CsvScanState *state) {
+    char *opens = state->quote_is_text ? NULL : p;
+    for (; p < end; p += CSV_BLOCK) {
+        uint64_t bits = csv_block_bits(p, end - p);
+        while (bits) {
+            char *at = p + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            if (state->in_quotes) {
+                if (*at == '"') {
+                    state->in_quotes = 0;
+                    opens = at + 1;
+                }
+            } else if (*at == '"') {
+                if (at == opens) state->in_quotes = 1;
+            } else if (*at == ',') {
+                if (state->field < CSV_FIELDS - 1) {
+                    state->field++;
+                    opens = at + 1;
+                }
+            } else {
+                memset(state, 0, sizeof(CsvScanState));
+                return at;
+            }
+        }
     }
-    
-    printf("\n╔════════════════════════════════════════╗\n");
-    printf("║           Review Details               ║\n");
-    printf("╚════════════════════════════════════════╝\n");
-    printf("Reviewer:  %s\n", reviews[index].reviewer_name);
-    printf("Score:     %d/5 ", reviews[index].satisfaction_score);
-    for (int i = 0; i < reviews[index].satisfaction_score; i++) printf("⭐");
-    printf("\n");
-    printf("Date:      %s\n", reviews[index].review_date);
-    printf("Feedback:  %s\n", reviews[index].feedback);
-    printf("────────────────────────────────────────\n");
+    state->quote_is_text = opens != end;
+    return NULL;
 }
 
-// search
+// Most bytes csv_put_row() can write for a row: every byte of a field
+// doubled, its quotes, a 3 digit score, the commas and the '\n'
+size_t csv_row_bound(int row) {
+    return 2 * (strlen(review_names[row]) + strlen(review_dates[row]) + strlen(review_feedbacks[row])) + 13;
+}
 
-void enhanced_search_menu() {
-    printf("\n╔════════════════════════════════════════╗\n");
-    printf("║         🔍 Search Options              ║\n");
-    printf("╚════════════════════════════════════════╝\n");
-    printf("1. Search by name (with typo correction)\n");
-    printf("2. Search by score range\n");
-    printf("3. Search by date\n");
-    printf("4. Back to main menu\n");
-    printf("Choice: ");
-    
-    int choice;
-    scanf("%d", &choice);
-    getchar();
-    
-    switch(choice) {
-        case 1:
-            search_reviews();
+// Format one row as a CSV record at dst, the same text for the CSV and for
+// backup chunks. Returns the end of it.
+char* csv_put_row(char *dst, int row) {
+    dst = csv_put_field(dst, review_names[row]);
+    uint8_t score = review_scores[row];
+    *dst++ = ',';
+    if (score >= 100) *dst++ = '0' + score / 100;
+    if (score >= 10) *dst++ = '0' + score / 10 % 10;
+    *dst++ = '0' + score % 10;
+    *dst++ = ',';
+    dst = csv_put_field(dst, review_dates[row]);
+    *dst++ = ',';
+    dst = csv_put_field(dst, review_feedbacks[row]);
+    *dst++ = '\n';
+    return dst;
+}
+
+// Fields holding ',', '"' or a line break are written quoted, with their
+// quotes doubled
+char* csv_put_field(char *dst, const char *field) {
+    size_t plain = strcspn(field, ",\"\r\n");
+    if (field[plain] == '\0') {
+        memcpy(dst, field, plain);
+        return dst + plain;
+    }
+    *dst++ = '"';
+    for (; *field; field++) {
+        if (*field == '"') *dst++ = '"';
+        *dst++ = *field;
+    }
+    *dst++ = '"';
+    return dst;
+}
+
+// Make room for bytes more in the buffer, writing out what is in it first
+void csv_writer_reserve(CsvWriter *writer, size_t bytes) {
+    if (writer->used + bytes <= writer->capacity) return;
+    csv_writer_flush(writer);
+    if (bytes > writer->capacity) {
+        writer->capacity = bytes;  // a row bigger than the whole buffer
+        writer->buffer = realloc(writer->buffer, writer->capacity);
+        if (!writer->buffer) {
+            printf("Memory reallocation failed!!\n");
+            exit(1);
+        }
+    }
+}
+
+void csv_writer_flush(CsvWriter *writer) {
+    size_t done = 0;
+    while (writer->ok && done < writer->used) {
+        ssize_t written = write(writer->fd, writer->buffer + done, writer->used - done);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) writer->ok = 0;
+        else done += written;
+    }
+    writer->used = 0;
+}
+
+// Sync the directory path is in, so a rename into it survives a crash too
+int fsync_parent_dir(const char *path) {
+    char dir[512];
+    snprintf(dir, sizeof(dir), "%s", path);
+    char *slash = strrchr(dir, '/');
+    if (!slash) {
+        strcpy(dir, ".");
+    } else {
+        slash[slash == dir] = '\0';  // keep the '/' of a file in the root
+    }
+    int fd = open(dir, O_RDONLY);
+    if (fd < 0) return -1;
+    int result = fsync(fd);
+    close(fd);
+    return result;
+}
+
+// The new CSV is written next to the file, synced and renamed over it, so
+// a crash leaves either the old file or the new one, never part of one.
+// (Truncating the file in place would also pull the pages out from under
+// the mmap loader.)
+int save_reviews_to_csv(const char *filename) {
+    char temp_filename[512];
+    snprintf(temp_filename, sizeof(temp_filename), "%s.tmp", filename);
+
+    compact_reviews();  // only the rows undo can still bring back are left
+
+    int fd = open(temp_filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        printf("Cannot create/open file for writing!\n");
+        return -1;
+    }
+
+    CsvWriter writer;
+    writer.fd = fd;
+    writer.capacity = CSV_WRITE_BUFFER;
+    writer.buffer = malloc(writer.capacity);
+    if (!writer.buffer) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    writer.ok = 1;
+
+    // Write header
+    const char *header = "ReviewerName,SatisfactionScore,ReviewDate,Feedback\n";
+    writer.used = strlen(header);
+    memcpy(writer.buffer, header, writer.used);
+
+    // Write review data
+    for (int i = 0; i < review_count; i++) {
+        if (!is_review_live(i)) continue;
+        csv_writer_reserve(&writer, csv_row_bound(i));
+        writer.used = csv_put_row(writer.buffer + writer.used, i) - writer.buffer;
+    }
+    csv_writer_flush(&writer);
+    free(writer.buffer);
+
+    if (writer.ok && fsync(fd) != 0) writer.ok = 0;
+    if (close(fd) != 0) writer.ok = 0;
+    if (!writer.ok || rename(temp_filename, filename) != 0) {
+        printf("Cannot create/open file for writing!\n");
+        remove(temp_filename);
+        return -1;
+    }
+    fsync_parent_dir(filename);
+    printf("Saved to reviews.csv\n");
+    return 0;
+}
+
+// write-ahead log
+// Every add, update and delete appends one small record to <CSV>.wal, so
+// keeping an edit costs the record and not a rewrite of the whole file.
+// Records are buffered and go out together at the end of each menu action
+// (wal_commit). The CSV is only rewritten by a checkpoint: on Save & Exit, or
+// once the log has grown to a quarter of the CSV.
+
+// Apply <filename>.wal to the rows just loaded from filename. Stops at the
+// first torn or damaged record (a crash mid-write), wal_open() cuts it off.
+// Returns the number of records applied.
+int wal_replay(const char *filename) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s.wal", filename);
+    wal_replay_end = 0;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(WalHeader)) {
+        close(fd);
+        return 0;
+    }
+    char *data = malloc(st.st_size);
+    if (!data) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    ssize_t got = read(fd, data, st.st_size);
+    close(fd);
+    if (got != st.st_size) {
+        free(data);
+        return 0;
+    }
+
+    // The log must belong to this very CSV, otherwise it is already in it
+    WalHeader header;
+    memcpy(&header, data, sizeof(header));
+    FileStamp base;
+    file_stamp(filename, &base);
+    if (memcmp(header.magic, WAL_MAGIC, sizeof(header.magic)) != 0 ||
+        memcmp(&header.base, &base, sizeof(base)) != 0) {
+        printf("⚠️  Ignoring %s, it does not match %s\n", path, filename);
+        free(data);
+        return 0;
+    }
+
+    // During replay no row moves, so row == id for everything the log names.
+    // Rows that come back in the middle (WAL_INSERT) are appended and linked
+    // into place in 'next', the table is put in that order at the end.
+    int *next = NULL;  // -1 = last row
+    int next_capacity = 0;
+    int head = -1, tail = -1;
+
+    int applied = 0;
+    const char *cursor = data + sizeof(WalHeader);
+    const char *end = data + st.st_size;
+    while (end - cursor >= 8) {
+        uint32_t length, checksum;
+        memcpy(&length, cursor, 4);
+        memcpy(&checksum, cursor + 4, 4);
+        if (length == 0 || length > (size_t)(end - cursor - 8) || wal_checksum(cursor + 8, length) != checksum) {
             break;
-        case 2: {
-            int min_score, max_score;
-            printf("Enter minimum score (1-5): ");
-            scanf("%d", &min_score);
-            printf("Enter maximum score (1-5): ");
-            scanf("%d", &max_score);
-            getchar();
-            
-            printf("\n=== Reviews with score %d-%d ===\n", min_score, max_score);
-            int found = 0;
-            for (int i = 0; i < review_count; i++) {
-                if (reviews[i].satisfaction_score >= min_score && 
-                    reviews[i].satisfaction_score <= max_score) {
-                    display_full_review(i);
-                    found++;
+        }
+        const char *field = cursor + 8;
+        const char *record_end = field + length;
+        uint8_t type = (uint8_t)*field++;
+
+        int ok = 1;
+        int32_t id = -1, count = 0;
+        uint8_t score = 0;
+        if (type == WAL_ADD || type == WAL_INSERT || type == WAL_UPDATE) {
+            if (type != WAL_ADD) ok = wal_get(&field, record_end, &id, 4);
+            const char *name = ok ? wal_get_string(&field, record_end) : NULL;
+            ok = name && wal_get(&field, record_end, &score, 1);
+            const char *date = ok ? wal_get_string(&field, record_end) : NULL;
+            const char *feedback = date ? wal_get_string(&field, record_end) : NULL;
+            ok = feedback && id >= -1 && id < review_count && (type != WAL_UPDATE || id >= 0);
+            if (ok && type == WAL_UPDATE) {
+                release_string(set_review_name(id, allocate_string(name)));
+                set_review_score(id, score);
+                release_string(set_review_date(id, allocate_string(date)));
+                release_string(set_review_feedback(id, allocate_string(feedback)));
+            } else if (ok) {
+                append_review(allocate_string(name), score, allocate_string(date), allocate_string(feedback));
+                int row = review_count - 1;
+                if (next || type == WAL_INSERT) {
+                    if (next_capacity < review_count) {
+                        int old_capacity = next_capacity;
+                        next_capacity = review_count * 2;
+                        next = realloc(next, next_capacity * sizeof(int));
+                        if (!next) {
+                            printf("Memory reallocation failed!!\n");
+                            exit(1);
+                        }
+                        if (old_capacity == 0) {
+                            // Until now the rows were in table order
+                            for (int i = 0; i < row; i++) next[i] = i + 1 < row ? i + 1 : -1;
+                            head = row > 0 ? 0 : -1;
+                            tail = row - 1;
+                        }
+                    }
+                    int after = type == WAL_ADD ? tail : id;
+                    if (after < 0) {
+                        next[row] = head;
+                        head = row;
+                        if (tail < 0) tail = row;
+                    } else {
+                        next[row] = next[after];
+                        next[after] = row;
+                        if (after == tail) tail = row;
+                    }
                 }
             }
-            if (found == 0) printf("No reviews found in this range.\n");
-            else printf("\nFound %d reviews.\n", found);
-            break;
-        }
-        case 3: {
-            char search_date[20];
-            printf("Enter date (YYYY-MM-DD): ");
-            fgets(search_date, sizeof(search_date), stdin);
-            search_date[strcspn(search_date, "\n")] = 0;
-            
-            printf("\n=== Reviews on %s ===\n", search_date);
-            int found = 0;
-            for (int i = 0; i < review_count; i++) {
-                if (strcmp(reviews[i].review_date, search_date) == 0) {
-                    display_full_review(i);
-                    found++;
+        } else if (type == WAL_DELETE || type == WAL_REVIVE) {
+            ok = wal_get(&field, record_end, &count, 4) && count >= 0 && (size_t)(record_end - field) == (size_t)count * 4;
+            for (int i = 0; ok && i < count; i++) {
+                wal_get(&field, record_end, &id, 4);
+                if (id < 0 || id >= review_count) {
+                    ok = 0;
+                } else if (type == WAL_DELETE) {
+                    kill_review_row(id);
+                } else {
+                    revive_review_row(id);
                 }
             }
-            if (found == 0) printf("No reviews found on this date.\n");
-            else printf("\nFound %d reviews.\n", found);
+        } else {
+            ok = 0;
+        }
+        if (!ok) {
             break;
         }
-        case 4:
-            return;
-        default:
-            printf("Invalid choice!\n");
+        applied++;
+        cursor = record_end;
+    }
+    wal_replay_end = cursor - data;
+    free(data);
+
+    if (next) {
+        int *order = malloc(review_count * sizeof(int));
+        if (!order) {
+            printf("Memory allocation failed!\n");
+            exit(1);
+        }
+        int count = 0;
+        for (int row = head; row >= 0 && count < review_count; row = next[row]) {
+            order[count++] = row;
+        }
+        if (count == review_count) permute_review_rows(order);
+        free(order);
+        free(next);
     }
+
+    if (applied > 0) {
+        printf("Recovered %d change(s) from %s\n", applied, path);
+    }
+    return applied;
 }
 
-void search_reviews() {
-    char query[100];
+// Start logging changes to filename. A log replay accepted is continued
+// (minus a torn tail), anything else is replaced by an empty one.
+int wal_open(const char *filename) {
+    snprintf(wal_base, sizeof(wal_base), "%s", filename);
+    snprintf(wal_path, sizeof(wal_path), "%s.wal", filename);
 
-    printf("\n╔════════════════════════════════════════╗\n");
-    printf("║        🔍 Search Reviews               ║\n");
-    printf("╚════════════════════════════════════════╝\n");
-    printf("Enter reviewer name: ");
-    fgets(query, sizeof(query), stdin);
-    query[strcspn(query, "\n")] = 0;
-    
-    if (strlen(query) == 0) {
-        printf("Search cancelled.\n");
-        return;
+    if (wal_replay_end > 0) {
+        wal_fd = open(wal_path, O_WRONLY);
+        if (wal_fd >= 0 && ftruncate(wal_fd, wal_replay_end) == 0 && lseek(wal_fd, 0, SEEK_END) == wal_replay_end) {
+            wal_size = wal_replay_end;
+            FileStamp base;
+            file_stamp(wal_base, &base);
+            wal_base_size = base.size;
+            return 0;
+        }
+        if (wal_fd >= 0) close(wal_fd);
+        wal_fd = -1;
     }
-    
-    printf("\n🔎 Searching for: '%s'\n", query);
-    printf("────────────────────────────────────────\n");
-    
-    int resultCount;
-    SearchResult* results = searchWithTypoCorrection(query, &resultCount, 3);
-    
-    if (resultCount == 0) {
-        printf("❌ No matches found.\n");
-        printf("\n💡 Tips:\n");
-        printf("  • Check spelling\n");
-        printf("  • Try shorter search term\n");
-        printf("  • Use partial name\n");
-        free(results);
+    return wal_reset();
+}
+
+// Replace the log with an empty one for the CSV as it is now. Written next
+// to it and renamed over, so there is always one complete header.
+int wal_reset() {
+    if (wal_fd >= 0) {
+        close(wal_fd);
+        wal_fd = -1;
+    }
+
+    WalHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, WAL_MAGIC, sizeof(header.magic));
+    file_stamp(wal_base, &header.base);
+    wal_base_size = header.base.size;
+
+    char temp_path[520];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", wal_path);
+    int fd = open(temp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || write(fd, &header, sizeof(header)) != (ssize_t)sizeof(header) ||
+        fsync(fd) != 0 || rename(temp_path, wal_path) != 0) {
+        if (fd >= 0) close(fd);
+        remove(temp_path);
+        printf("⚠️  Cannot write %s, changes are only saved on exit\n", wal_path);
+        use_wal = 0;
+        return -1;
+    }
+    wal_fd = fd;
+    wal_size = sizeof(header);
+    wal_buffer_used = 0;
+    wal_unsynced = 0;
+    return 0;
+}
+
+// Fold the log into the CSV: rewrite the CSV, then start an empty log for it.
+// A crash in between leaves a log whose header names the old CSV, replay
+// skips it. Returns 0 once the CSV holds everything.
+int wal_checkpoint() {
+    // Kept in the log in case the CSV can't be written
+    if (wal_flush() != 0) {
+        return -1;
+    }
+    if (wal_fd < 0) {
+        return 0;  // the flush fell back to writing the CSV
+    }
+    if (save_reviews_to_csv(wal_base) != 0) {
+        return -1;
+    }
+    save_snapshot(wal_base);  // startup reads this instead of parsing the CSV
+
+    // Ids now count the rows of the new CSV, rows undo can still bring back
+    // are not in it
+    int rank = 0;
+    for (int i = 0; i < review_count; i++) {
+        review_ids[i] = is_review_live(i) ? rank++ : -1;
+    }
+    next_review_id = rank;
+    wal_reset();  // if that fails logging stops, the CSV has everything
+    return 0;
+}
+
+// Group commit: everything logged since the last commit goes out with one
+// write and one fdatasync, however many rows the action touched. Returns 0
+// once it is on disk, -1 if it is not (the caller must say so).
+int wal_commit() {
+    // A big group may have been written already (wal_end_record), it still
+    // needs its sync
+    if (wal_fd < 0 || (wal_buffer_used == 0 && !wal_unsynced)) return 0;
+
+    if (wal_flush() != 0) {
+        return -1;
+    }
+    if (wal_fd >= 0 && fdatasync(wal_fd) != 0) {
+        // What the page cache holds after a failed sync can't be trusted
+        printf("⚠️  Cannot sync %s, saving %s instead\n", wal_path, wal_base);
+        return wal_fall_back();
+    }
+    wal_unsynced = 0;
+    if (wal_fd >= 0 && wal_size >= WAL_CHECKPOINT_BYTES &&
+        (uint64_t)wal_size * WAL_CHECKPOINT_RATIO >= wal_base_size) {
+        wal_checkpoint();  // the log is on disk already, a failed checkpoint loses nothing
+    }
+    return 0;
+}
+
+// Write the buffered records (no sync). If that fails the CSV is rewritten
+// instead and logging stops. Returns -1 if that failed too.
+int wal_flush() {
+    if (wal_fd < 0) {
+        wal_buffer_used = 0;
+        return 0;
+    }
+    size_t done = 0;
+    while (done < wal_buffer_used) {
+        ssize_t written = write(wal_fd, wal_buffer + done, wal_buffer_used - done);
+        if (written <= 0) {
+            printf("⚠️  Cannot write %s, saving %s instead\n", wal_path, wal_base);
+            return wal_fall_back();
+        }
+        done += written;
+    }
+    wal_size += wal_buffer_used;
+    if (wal_buffer_used > 0) wal_unsynced = 1;
+    wal_buffer_used = 0;
+    return 0;
+}
+
+// Stop logging and write the whole CSV instead, the log can't be trusted
+// any more. Returns 0 if the CSV was written.
+int wal_fall_back() {
+    close(wal_fd);
+    wal_fd = -1;
+    use_wal = 0;
+    wal_buffer_used = 0;
+    wal_unsynced = 0;
+    if (save_reviews_to_csv(wal_base) != 0) {
+        printf("❌ Cannot save %s either, the changes are not on disk!\n", wal_base);
+        return -1;
+    }
+    return 0;
+}
+
+void wal_close() {
+    wal_commit();
+    if (wal_fd >= 0) {
+        close(wal_fd);
+        wal_fd = -1;
+    }
+    free(wal_buffer);
+    wal_buffer = NULL;
+    wal_buffer_used = wal_buffer_capacity = 0;
+}
+
+// FNV-1a, enough to spot a torn or garbled record
+uint32_t wal_checksum(const char *data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void wal_reserve(size_t bytes) {
+    if (wal_buffer_used + bytes <= wal_buffer_capacity) return;
+
+    while (wal_buffer_used + bytes > wal_buffer_capacity) {
+        wal_buffer_capacity = wal_buffer_capacity ? wal_buffer_capacity * 2 : 4096;
+    }
+    wal_buffer = realloc(wal_buffer, wal_buffer_capacity);
+    if (!wal_buffer) {
+        printf("Memory reallocation failed!!\n");
+        exit(1);
+    }
+}
+
+void wal_put(const void *data, size_t length) {
+    wal_reserve(length);
+    memcpy(wal_buffer + wal_buffer_used, data, length);
+    wal_buffer_used += length;
+}
+
+// Length, then the bytes with their '\0' so replay can use them in place
+void wal_put_string(const char *str) {
+    uint32_t length = strlen(str);
+    wal_put(&length, 4);
+    wal_put(str, length + 1);
+}
+
+void wal_put_review(int row) {
+    uint8_t score = review_scores[row];
+    wal_put_string(review_names[row]);
+    wal_put(&score, 1);
+    wal_put_string(review_dates[row]);
+    wal_put_string(review_feedbacks[row]);
+}
+
+void wal_begin_record(WalRecordType type) {
+    uint8_t tag = type;
+    wal_record_start = wal_buffer_used;
+    wal_reserve(9);
+    wal_buffer_used += 8;  // length and checksum, see wal_end_record()
+    wal_put(&tag, 1);
+}
+
+void wal_end_record() {
+    uint32_t length = wal_buffer_used - wal_record_start - 8;
+    uint32_t checksum = wal_checksum(wal_buffer + wal_record_start + 8, length);
+    memcpy(wal_buffer + wal_record_start, &length, 4);
+    memcpy(wal_buffer + wal_record_start + 4, &checksum, 4);
+    if (wal_buffer_used >= WAL_FLUSH_BYTES) wal_flush();
+}
+
+void wal_log_add(int row) {
+    if (wal_fd < 0) return;
+    wal_begin_record(WAL_ADD);
+    wal_put_review(row);
+    wal_end_record();
+}
+
+void wal_log_update(int row) {
+    if (wal_fd < 0) return;
+    wal_begin_record(WAL_UPDATE);
+    wal_put(&review_ids[row], 4);
+    wal_put_review(row);
+    wal_end_record();
+}
+
+void wal_log_delete(const int *rows, int count) {
+    if (wal_fd < 0) return;
+    int32_t logged = 0;
+    wal_begin_record(WAL_DELETE);
+    size_t count_at = wal_buffer_used;
+    wal_put(&logged, 4);
+    for (int i = 0; i < count; i++) {
+        if (rows[i] < 0 || review_ids[rows[i]] < 0) continue;
+        wal_put(&review_ids[rows[i]], 4);
+        logged++;
+    }
+    if (logged == 0) {
+        wal_buffer_used = wal_record_start;  // nothing the log knows about
+        return;
+    }
+    memcpy(wal_buffer + count_at, &logged, 4);
+    wal_end_record();
+}
+
+// Rows the log knows come back by id, rows deleted before the last checkpoint
+// (not in the CSV) are written out whole, after the nearest row it has
+void wal_log_revive(const int *rows, int count) {
+    if (wal_fd < 0) return;
+
+    int *sorted = malloc((count > 0 ? count : 1) * sizeof(int));
+    if (!sorted) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    memcpy(sorted, rows, count * sizeof(int));
+    qsort(sorted, count, sizeof(int), compare_rows);  // so earlier rows get ids first
+
+    int32_t known = 0;
+    for (int i = 0; i < count; i++) {
+        int row = sorted[i];
+        if (row < 0) continue;
+        if (review_ids[row] >= 0) {
+            sorted[known++] = row;
+            continue;
+        }
+        int32_t after = -1;
+        for (int before = row - 1; before >= 0; before--) {
+            if (review_ids[before] >= 0) {
+                after = review_ids[before];
+                break;
+            }
+        }
+        review_ids[row] = next_review_id++;
+        wal_begin_record(WAL_INSERT);
+        wal_put(&after, 4);
+        wal_put_review(row);
+        wal_end_record();
+    }
+
+    if (known > 0) {
+        wal_begin_record(WAL_REVIVE);
+        wal_put(&known, 4);
+        for (int i = 0; i < known; i++) {
+            wal_put(&review_ids[sorted[i]], 4);
+        }
+        wal_end_record();
+    }
+    free(sorted);
+}
+
+// Read 'length' bytes of a record, 0 if it is too short
+int wal_get(const char **cursor, const char *end, void *out, size_t length) {
+    if ((size_t)(end - *cursor) < length) return 0;
+    memcpy(out, *cursor, length);
+    *cursor += length;
+    return 1;
+}
+
+// A string of a record, NULL if it runs past the end
+const char* wal_get_string(const char **cursor, const char *end) {
+    uint32_t length;
+    if (!wal_get(cursor, end, &length, 4)) return NULL;
+    if ((size_t)(end - *cursor) <= length || (*cursor)[length] != '\0') return NULL;
+    const char *str = *cursor;
+    *cursor += length + 1;
+    return str;
+}
+
+int compare_rows(const void *a, const void *b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// binary snapshot
+// <CSV>.snap holds the same rows as the CSV in load-ready form: the score and
+// date key columns as they sit in memory, one offset table and one heap with
+// every string. Loading is a mmap, a CRC32C pass over each block and pointer
+// setup, no parsing. It is written whenever the CSV is and only used while it
+// is a copy of the CSV on disk.
+
+// Load <filename>.snap if it is a valid copy of filename.
+// Returns 0 on success, -2 if there is no usable snapshot (read the CSV).
+int load_reviews_snapshot(const char *filename) {
+    if (mapped_csv || review_count != 0) {
+        return -2;
+    }
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s.snap", filename);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -2;
+    }
+    struct stat st;
+    FileStamp csv;
+    file_stamp(filename, &csv);
+    int64_t snap_mtime_ns = 0;
+    if (fstat(fd, &st) == 0) {
+        snap_mtime_ns = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+    }
+    if (snap_mtime_ns < csv.mtime_ns || st.st_size < (off_t)sizeof(SnapHeader)) {
+        close(fd);  // the CSV was written after it
+        return -2;
+    }
+
+    size_t size = (size_t)st.st_size;
+    char *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return -2;
+    }
+    madvise(data, size, MADV_SEQUENTIAL);
+
+    SnapHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, SNAP_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != SNAP_VERSION || header.block_count != SNAP_BLOCK_COUNT ||
+        crc32c(0, &header, offsetof(SnapHeader, header_crc)) != header.header_crc ||
+        memcmp(&header.csv, &csv, sizeof(csv)) != 0 || header.row_count > INT_MAX) {
+        munmap(data, size);
+        return -2;
+    }
+
+    uint64_t rows = header.row_count;
+    uint64_t expected[SNAP_BLOCK_COUNT] = {rows, rows * sizeof(int32_t), rows * 3 * sizeof(uint64_t), 0};
+    for (int b = 0; b < SNAP_BLOCK_COUNT; b++) {
+        SnapBlock *block = &header.blocks[b];
+        if (block->offset > size || block->size > size - block->offset ||
+            (b != SNAP_HEAP && block->size != expected[b]) ||
+            crc32c(0, data + block->offset, block->size) != block->crc) {
+            printf("⚠️  %s is damaged, reading %s instead\n", path, filename);
+            munmap(data, size);
+            return -2;
+        }
+    }
+
+    // Every string must end inside the heap
+    const char *heap = data + header.blocks[SNAP_HEAP].offset;
+    uint64_t heap_size = header.blocks[SNAP_HEAP].size;
+    const uint64_t *offsets = (const uint64_t*)(data + header.blocks[SNAP_OFFSETS].offset);
+    if (rows > 0 && (heap_size == 0 || heap[heap_size - 1] != '\0')) {
+        munmap(data, size);
+        return -2;
+    }
+    for (uint64_t i = 0; i < rows * 3; i++) {
+        if (offsets[i] >= heap_size) {
+            munmap(data, size);
+            return -2;
+        }
+    }
+
+    reserve_reviews((int)rows);
+    memcpy(review_scores, data + header.blocks[SNAP_SCORES].offset, rows);
+    memcpy(review_date_keys, data + header.blocks[SNAP_DATE_KEYS].offset, rows * sizeof(int32_t));
+    for (int i = 0; i < (int)rows; i++) {
+        review_names[i] = (char*)heap + offsets[3 * i];
+        review_dates[i] = (char*)heap + offsets[3 * i + 1];
+        review_feedbacks[i] = (char*)heap + offsets[3 * i + 2];
+        review_ids[i] = i;
+    }
+    review_count = (int)rows;
+    next_review_id = (int32_t)rows;
+
+    // The strings live in the mapping now, like with the CSV mmap loader
+    mapped_csv = data;
+    mapped_csv_size = size;
+    return 0;
+}
+
+// Write <csv_filename>.snap for the CSV just saved (the live rows, in order).
+// Written next to it and renamed over, a failed write leaves no snapshot.
+int save_snapshot(const char *csv_filename) {
+    char path[512], temp_path[520];
+    snprintf(path, sizeof(path), "%s.snap", csv_filename);
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+
+    FILE *file = fopen(temp_path, "w");
+    if (!file) {
+        return -1;
+    }
+
+    SnapHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAP_MAGIC, sizeof(header.magic));
+    header.version = SNAP_VERSION;
+    header.block_count = SNAP_BLOCK_COUNT;
+    header.row_count = live_review_count();
+    file_stamp(csv_filename, &header.csv);
+
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    uint64_t at = sizeof(header);
+    for (int b = 0; ok && b < SNAP_BLOCK_COUNT; b++) {
+        // Pad to the block boundary
+        static const char zeros[SNAP_ALIGN];
+        uint64_t pad = (SNAP_ALIGN - at % SNAP_ALIGN) % SNAP_ALIGN;
+        ok = pad == 0 || fwrite(zeros, pad, 1, file) == 1;
+        at += pad;
+
+        SnapBlock *block = &header.blocks[b];
+        block->offset = at;
+        if (b == SNAP_SCORES || b == SNAP_DATE_KEYS) {
+            // Columns go out a run of live rows at a time
+            const char *column = b == SNAP_SCORES ? (const char*)review_scores : (const char*)review_date_keys;
+            size_t width = b == SNAP_SCORES ? sizeof(uint8_t) : sizeof(int32_t);
+            int row = next_row_in_state(0, 0);
+            while (ok && row < review_count) {
+                int end = next_row_in_state(row, 1);
+                ok = snapshot_write(file, column + row * width, (end - row) * width, block);
+                row = next_row_in_state(end, 0);
+            }
+        } else {
+            uint64_t offsets[3 * 1024];
+            int pending = 0;
+            uint64_t heap_offset = 0;
+            for (int i = 0; ok && i < review_count; i++) {
+                if (!is_review_live(i)) continue;
+                const char *fields[3] = {review_names[i], review_dates[i], review_feedbacks[i]};
+                for (int f = 0; ok && f < 3; f++) {
+                    size_t length = strlen(fields[f]) + 1;
+                    if (b == SNAP_HEAP) {
+                        ok = snapshot_write(file, fields[f], length, block);
+                    } else {
+                        offsets[pending++] = heap_offset;
+                    }
+                    heap_offset += length;
+                }
+                if (pending == 3 * 1024) {
+                    ok = snapshot_write(file, offsets, sizeof(offsets), block);
+                    pending = 0;
+                }
+            }
+            if (ok && pending > 0) ok = snapshot_write(file, offsets, pending * sizeof(uint64_t), block);
+        }
+        at += block->size;
+    }
+    header.header_crc = crc32c(0, &header, offsetof(SnapHeader, header_crc));
+
+    ok = ok && fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1 &&
+         fflush(file) == 0 && fsync(fileno(file)) == 0;
+    if (fclose(file) != 0 || !ok || rename(temp_path, path) != 0) {
+        remove(temp_path);
+        return -1;
+    }
+    return 0;
+}
+
+// fwrite that keeps the block's size and CRC up to date
+int snapshot_write(FILE *file, const void *data, size_t length, SnapBlock *block) {
+    block->crc = crc32c(block->crc, data, length);
+    block->size += length;
+    return fwrite(data, length, 1, file) == 1;
+}
+
+// Stamp of path: inode, size and modification time, all 0 if it is missing
+int file_stamp(const char *path, FileStamp *stamp) {
+    memset(stamp, 0, sizeof(FileStamp));
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return -1;
+    }
+    stamp->inode = st.st_ino;
+    stamp->size = st.st_size;
+    stamp->mtime_ns = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+    return 0;
+}
+
+// CRC32C (Castagnoli), chained: pass the previous result to continue a CRC.
+// Uses the SSE4.2 crc32 instruction when the CPU has it, 8 bytes at a time.
+uint32_t crc32c(uint32_t crc, const void *data, size_t length) {
+#if defined(__x86_64__)
+    if (__builtin_cpu_supports("sse4.2")) {
+        return crc32c_sse42(crc, data, length);
+    }
+#endif
+    return crc32c_table(crc, data, length);
+}
+
+uint32_t crc32c_table(uint32_t crc, const void *data, size_t length) {
+    static uint32_t table[256];
+    static int table_ready = 0;
+    if (!table_ready) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; bit++) {
+                value = (value >> 1) ^ (0x82F63B78u & -(value & 1));
+            }
+            table[i] = value;
+        }
+        table_ready = 1;
+    }
+
+    const unsigned char *bytes = data;
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2")))
+uint32_t crc32c_sse42(uint32_t crc, const void *data, size_t length) {
+    const unsigned char *bytes = data;
+    uint64_t value = ~crc;
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, bytes, 8);
+        value = _mm_crc32_u64(value, word);
+        bytes += 8;
+        length -= 8;
+    }
+    uint32_t tail = (uint32_t)value;
+    while (length-- > 0) {
+        tail = _mm_crc32_u8(tail, *bytes++);
+    }
+    return ~tail;
+}
+#endif
+
+// review table
+// All row changes go through these so every column stays in step
+
+// Append a row, the table takes ownership of the strings
+void append_review(char *name, int score, char *date, char *feedback) {
+    if (review_count >= capacity) {
+        resize_review_array();
+    }
+
+    review_names[review_count] = name;
+    review_scores[review_count] = pack_score(score);
+    review_date_keys[review_count] = pack_date(date);
+    review_dates[review_count] = date;
+    review_feedbacks[review_count] = feedback;
+    review_ids[review_count] = next_review_id++;
+    review_count++;
+
+    if (bk_built) bk_add_row(name, review_count - 1);
+    if (name_index_built) name_index_add_row(name, review_count - 1);
+    if (date_index_built) date_index_add_row(review_count - 1);
+}
+
+// Delete a row in O(1): mark it dead, its strings and index entries stay
+// until the next compaction (call maybe_compact_reviews() when done deleting)
+void kill_review_row(int index) {
+    if (!is_review_live(index)) return;
+    review_dead[index / 64] |= 1ULL << (index % 64);
+    dead_count++;
+    mark_row_changed(index);
+}
+
+// Bring a dead row back as it was (its index entries never went away).
+// Only pinned rows are guaranteed to still be there.
+void revive_review_row(int index) {
+    if (is_review_live(index)) return;
+    set_review_pinned(index, 0);
+    review_dead[index / 64] &= ~(1ULL << (index % 64));
+    dead_count--;
+    mark_row_changed(index);
+}
+
+int is_review_live(int index) {
+    return !((review_dead[index / 64] >> (index % 64)) & 1);
+}
+
+int is_review_pinned(int index) {
+    return (review_pinned[index / 64] >> (index % 64)) & 1;
+}
+
+void set_review_pinned(int index, int pinned) {
+    if (is_review_pinned(index) == !!pinned) return;
+    review_pinned[index / 64] ^= 1ULL << (index % 64);
+    pinned_count += pinned ? 1 : -1;
+}
+
+int live_review_count() {
+    return review_count - dead_count;
+}
+
+// Position of a live row among the live rows, i.e. its number after compaction
+int live_rank(int index) {
+    if (dead_count == 0) return index;
+
+    int dead_before = 0;
+    for (int w = 0; w < index / 64; w++) {
+        dead_before += __builtin_popcountll(review_dead[w]);
+    }
+    uint64_t below = (1ULL << (index % 64)) - 1;
+    dead_before += __builtin_popcountll(review_dead[index / 64] & below);
+    return index - dead_before;
+}
+
+// Row of the rank-th live row (0 based), the inverse of live_rank()
+int row_of_live_rank(int rank) {
+    if (dead_count == 0) return rank;
+
+    int words = (review_count + 63) / 64;
+    for (int w = 0; w < words; w++) {
+        uint64_t live = ~review_dead[w];
+        if (w == words - 1 && review_count % 64) live &= (1ULL << (review_count % 64)) - 1;
+        int here = __builtin_popcountll(live);
+        if (rank >= here) {
+            rank -= here;
+            continue;
+        }
+        while (rank-- > 0) live &= live - 1;  // drop the lower live rows
+        return w * 64 + __builtin_ctzll(live);
+    }
+    return -1;
+}
+
+// Drop every dead row in one pass: release its strings, close the gaps in
+// every column and renumber the indexes once. Pinned rows move down with the
+// live ones and stay dead.
+void compact_reviews() {
+    if (dead_count == pinned_count) return;
+
+    // new_row[old] = where the row ends up, -1 if it goes
+    int *new_row = malloc(review_count * sizeof(int));
+    if (!new_row) return;  // keep the tombstones, everything still skips them
+
+    int write = 0;
+    for (int read = 0; read < review_count; read++) {
+        int live = is_review_live(read);
+        int pinned = is_review_pinned(read);
+        int changed = (review_changed[read / 64] >> (read % 64)) & 1;
+        if (!live && !pinned) {
+            if (changed) backup_drop_row(read);
+            release_review(get_review(read));
+            new_row[read] = -1;
+            continue;
+        }
+        // write <= read, so these bits are never read again
+        uint64_t bit = 1ULL << (write % 64);
+        review_dead[write / 64] = live ? review_dead[write / 64] & ~bit : review_dead[write / 64] | bit;
+        review_pinned[write / 64] = pinned ? review_pinned[write / 64] | bit : review_pinned[write / 64] & ~bit;
+        review_changed[write / 64] = changed ? review_changed[write / 64] | bit : review_changed[write / 64] & ~bit;
+        review_names[write] = review_names[read];
+        review_scores[write] = review_scores[read];
+        review_date_keys[write] = review_date_keys[read];
+        review_dates[write] = review_dates[read];
+        review_feedbacks[write] = review_feedbacks[read];
+        review_ids[write] = review_ids[read];
+        new_row[read] = write++;
+    }
+    // Clear what is left of the old tail
+    for (int row = write; row < review_count && row % 64; row++) {
+        review_dead[row / 64] &= ~(1ULL << (row % 64));
+        review_pinned[row / 64] &= ~(1ULL << (row % 64));
+        review_changed[row / 64] &= ~(1ULL << (row % 64));
+    }
+    int first_word = (write + 63) / 64, words = (review_count + 63) / 64;
+    if (words > first_word) {
+        memset(review_dead + first_word, 0, (words - first_word) * sizeof(uint64_t));
+        memset(review_pinned + first_word, 0, (words - first_word) * sizeof(uint64_t));
+        memset(review_changed + first_word, 0, (words - first_word) * sizeof(uint64_t));
+    }
+    review_count = write;
+    dead_count = pinned_count;
+
+    if (bk_built) bk_remap_rows(new_row);
+    if (name_index_built) name_index_remap_rows(new_row);
+    if (date_index_built) date_index_remap_rows(new_row);
+    undo_remap_rows(new_row);
+    backup_remap_rows(new_row);
+    free(new_row);
+}
+
+void maybe_compact_reviews() {
+    if ((long long)(dead_count - pinned_count) * 100 >= (long long)review_count * COMPACT_DEAD_PERCENT) {
+        compact_reviews();
+    }
+}
+
+// Put the rows in the given order (order[i] = old row of new row i), every
+// column moves and the indexes are built again when next needed
+void permute_review_rows(const int *order) {
+    char **names = malloc(review_count * sizeof(char*));
+    uint8_t *scores = malloc(review_count * sizeof(uint8_t));
+    int32_t *date_keys = malloc(review_count * sizeof(int32_t));
+    char **dates = malloc(review_count * sizeof(char*));
+    char **feedbacks = malloc(review_count * sizeof(char*));
+    int32_t *ids = malloc(review_count * sizeof(int32_t));
+    int words = (review_count + 63) / 64;
+    uint64_t *dead = calloc(words, sizeof(uint64_t));
+    uint64_t *pinned = calloc(words, sizeof(uint64_t));
+    if (!names || !scores || !date_keys || !dates || !feedbacks || !ids || !dead || !pinned) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    for (int i = 0; i < review_count; i++) {
+        int row = order[i];
+        names[i] = review_names[row];
+        scores[i] = review_scores[row];
+        date_keys[i] = review_date_keys[row];
+        dates[i] = review_dates[row];
+        feedbacks[i] = review_feedbacks[row];
+        ids[i] = review_ids[row];
+        if (!is_review_live(row)) dead[i / 64] |= 1ULL << (i % 64);
+        if (is_review_pinned(row)) pinned[i / 64] |= 1ULL << (i % 64);
+    }
+    memcpy(review_names, names, review_count * sizeof(char*));
+    memcpy(review_scores, scores, review_count * sizeof(uint8_t));
+    memcpy(review_date_keys, date_keys, review_count * sizeof(int32_t));
+    memcpy(review_dates, dates, review_count * sizeof(char*));
+    memcpy(review_feedbacks, feedbacks, review_count * sizeof(char*));
+    memcpy(review_ids, ids, review_count * sizeof(int32_t));
+    memcpy(review_dead, dead, words * sizeof(uint64_t));
+    memcpy(review_pinned, pinned, words * sizeof(uint64_t));
+    free(dead);
+    free(pinned);
+    free(names);
+    free(scores);
+    free(date_keys);
+    free(dates);
+    free(feedbacks);
+    free(ids);
+
+    name_index_free();
+    date_index_free();
+    bk_free();
+    backup_forget();
+}
+
+void release_review(Review review) {
+    release_string(review.reviewer_name);
+    release_string(review.review_date);
+    release_string(review.feedback);
+}
+
+// Row view of the columns, for code that wants a whole review at once
+Review get_review(int index) {
+    Review review;
+    review.reviewer_name = review_names[index];
+    review.satisfaction_score = review_scores[index];
+    review.review_date = review_dates[index];
+    review.feedback = review_feedbacks[index];
+    return review;
+}
+
+// Setters take ownership of the new value and hand back the old one,
+// release it or keep it (the undo journal does)
+char* set_review_name(int index, char *name) {
+    if (bk_built) {
+        bk_remove_row(review_names[index], index);
+        bk_add_row(name, index);
+    }
+    if (name_index_built) {
+        name_index_remove_row(review_names[index], index);
+        name_index_add_row(name, index);
+    }
+    char *old = review_names[index];
+    review_names[index] = name;
+    mark_row_changed(index);
+    return old;
+}
+
+int set_review_score(int index, int score) {
+    int old = review_scores[index];
+    review_scores[index] = pack_score(score);
+    mark_row_changed(index);
+    return old;
+}
+
+char* set_review_date(int index, char *date) {
+    if (date_index_built) date_index_remove_row(index);
+    char *old = review_dates[index];
+    review_dates[index] = date;
+    review_date_keys[index] = pack_date(date);
+    if (date_index_built) date_index_add_row(index);
+    mark_row_changed(index);
+    return old;
+}
+
+char* set_review_feedback(int index, char *feedback) {
+    char *old = review_feedbacks[index];
+    review_feedbacks[index] = feedback;
+    mark_row_changed(index);
+    return old;
+}
+
+// Scores outside 0-255 can't be packed, store them as 0 (out of range anyway).
+// Loaded rows are checked first (loaded_score), edits only allow 1-5.
+uint8_t pack_score(int score) {
+    if (score < 0 || score > 255) return 0;
+    return (uint8_t)score;
+}
+
+// Score field of a row being loaded, -1 if the column can't hold it. Such a
+// row is left out (and counted in skipped_rows): storing 0 would write a
+// different score back on the next save.
+int loaded_score(const char *text) {
+    long score = strtol(text, NULL, 10);
+    return score >= 0 && score <= 255 ? (int)score : -1;
+}
+
+void report_skipped_rows() {
+    if (skipped_rows > 0) {
+        printf("⚠️  Skipped %d row(s) with a score outside 0-255, saving leaves them out\n", skipped_rows);
+    }
+}
+
+// "2025-08-01" -> 20250801, the era is kept as typed (BE stays BE)
+int32_t pack_date(const char *date_str) {
+    if (!is_valid_date(date_str)) return 0;
+
+    int32_t packed = 0;
+    for (int i = 0; i < 10; i++) {
+        if (i == 4 || i == 7) continue;
+        packed = packed * 10 + (date_str[i] - '0');
+    }
+    return packed;
+}
+
+// review operations
+void add_review() {
+    printf("\n=== Add New Review\n");
+
+    char temp_name[256], temp_date[50], temp_feedback[512];
+    int temp_score;
+
+    printf("Enter reviewer name: ");
+    fgets(temp_name, sizeof(temp_name), stdin);
+    temp_name[strcspn(temp_name, "\n")] = 0;
+
+    while (strlen(temp_name) == 0 || strlen(temp_name) > 50) {
+        if (strlen(temp_name) == 0) {
+            printf("Name cannot be empty! ");
+        } else {
+            printf("Name too long (max 50 characters)! ");
+        }
+        printf("Enter reviewer name: ");
+        fgets(temp_name, sizeof(temp_name), stdin);
+        temp_name[strcspn(temp_name, "\n")] = 0;
+    }
+
+    do {
+        printf("Enter satisfaction score (1-5): ");
+        int result = scanf("%d", &temp_score);
+        if (result != 1) {
+            printf("Invalid input! Enter number instead\n");
+
+            int c;
+            while ((c = getchar()) != '\n' && c != EOF);
+
+            temp_score = 0;
+        } else if (temp_score < 1 || temp_score > 5) {
+            printf("Please enter a score between 1 to 5\n");
+        }
+    } while (temp_score < 1 || temp_score > 5);
+
+    getchar();
+
+    printf("Enter review date (YYYY-MM-DD): ");
+    fgets(temp_date, sizeof(temp_date), stdin);
+    temp_date[strcspn(temp_date, "\n")] = 0; // Remove newline
+
+    while (!is_valid_date(temp_date)) {
+        printf("Invalid date format! Use YYYY-MM-DD: ");
+        fgets(temp_date, sizeof(temp_date), stdin);
+        temp_date[strcspn(temp_date, "\n")] = 0;
+    }
+
+    printf("Enter feedback: ");
+    fgets(temp_feedback, sizeof(temp_feedback), stdin);
+    temp_feedback[strcspn(temp_feedback, "\n")] = 0;
+
+    while (strlen(temp_feedback) > 200) {
+        printf("Feedback too long! Max 200 characters. Try again: ");
+        fgets(temp_feedback, sizeof(temp_feedback), stdin);
+        temp_feedback[strcspn(temp_feedback, "\n")] = 0;
+    }
+
+    add_review_row(allocate_string(temp_name), temp_score,
+                   allocate_string(temp_date), allocate_string(temp_feedback));
+    printf("Review added!! yay\n");
+}
+
+// Add a checked review as one undo step and one log record
+void add_review_row(char *name, int score, char *date, char *feedback) {
+    append_review(name, score, date, feedback);
+    int row = review_count - 1;
+    Review unchanged = {NULL, -1, NULL, NULL};
+    undo_record(UNDO_ADD, &row, 1, unchanged);
+    wal_log_add(row);
+}
+
+void display_all_reviews() {
+
+    printf("\n=== All Customer Reviews ===\n");
+    compact_reviews();  // only rows undo can bring back are still dead
+
+    int live_count = live_review_count();
+    if (live_count == 0) {
+        printf("No reviews found.\n");
+        return;
+    }
+
+    printf("\n=== All Customer Reviews ===\n");
+    printf("%-4s %-20s %-6s %-12s %-50s\n", "#", "Reviewer", "Score", "Date", "Feedback");
+    printf("------------------------------------------------------------------------\n");
+
+    // Live rows are numbered 1..n, the numbers other menus take
+    int number = 0;
+    for (int i = 0; i < review_count; i++) {
+        if (!is_review_live(i)) continue;
+        char display_feedback[51];
+        if(strlen(review_feedbacks[i]) > 50) {
+            strncpy(display_feedback, review_feedbacks[i], 47);
+            strcpy(display_feedback + 47, "...");
+        } else {
+            strcpy(display_feedback, review_feedbacks[i]);
+        }
+
+        printf("%-4d %-20s %-6d %-12s %-50s\n",
+                ++number,
+                review_names[i],
+                review_scores[i],
+                review_dates[i],
+                display_feedback);
+    }
+
+    printf("\nTotal reviews: %d\n", live_count);
+
+    ScoreStats stats;
+    compute_live_score_stats(&stats);
+    printf("Average satisfaction score: %.2f/5\n", (double)stats.sum_all / live_count);
+}
+
+void update_review() {
+    int live_count = live_review_count();
+    if (live_count == 0) {
+        printf("No reviews to update.\n");
+        return;
+    }
+    
+    display_all_reviews();
+    
+    printf("\nEnter review number to update (1-%d): ", live_count);
+    int choice;
+    scanf("%d", &choice);
+    getchar();
+    
+    if (choice < 1 || choice > live_count) {
+        printf("Invalid choice!\n");
+        return;
+    }
+    
+    int index = row_of_live_rank(choice - 1);
+    
+    printf("\n=== Updating Review #%d ===\n", choice);
+    display_full_review(index);
+    
+    printf("\nWhat do you want to update?\n");
+    printf("1. Reviewer Name\n");
+    printf("2. Satisfaction Score\n");
+    printf("3. Review Date\n");
+    printf("4. Feedback\n");
+    printf("5. Update All Fields\n");
+    printf("Choice: ");
+    
+    int update_choice;
+    scanf("%d", &update_choice);
+    getchar();
+    
+    char temp_buffer[512];
+    int temp_score;
+    Review old = {NULL, -1, NULL, NULL};  // what the update replaced, for undo
+    
+    switch(update_choice) {
+        case 1:
+            printf("Enter new reviewer name: ");
+            fgets(temp_buffer, sizeof(temp_buffer), stdin);
+            temp_buffer[strcspn(temp_buffer, "\n")] = 0;
+            old.reviewer_name = set_review_name(index, allocate_string(temp_buffer));
+            printf("✅ Name updated!\n");
+            break;
+            
+        case 2:
+            do {
+                printf("Enter new satisfaction score (1-5): ");
+                scanf("%d", &temp_score);
+            } while (temp_score < 1 || temp_score > 5);
+            old.satisfaction_score = set_review_score(index, temp_score);
+            printf("✅ Score updated!\n");
+            break;
+            
+        case 3:
+            printf("Enter new review date (YYYY-MM-DD): ");
+            fgets(temp_buffer, sizeof(temp_buffer), stdin);
+            temp_buffer[strcspn(temp_buffer, "\n")] = 0;
+            old.review_date = set_review_date(index, allocate_string(temp_buffer));
+            printf("✅ Date updated!\n");
+            break;
+            
+        case 4:
+            printf("Enter new feedback: ");
+            fgets(temp_buffer, sizeof(temp_buffer), stdin);
+            temp_buffer[strcspn(temp_buffer, "\n")] = 0;
+            old.feedback = set_review_feedback(index, allocate_string(temp_buffer));
+            printf("✅ Feedback updated!\n");
+            break;
+            
+        case 5:
+            printf("Enter new reviewer name: ");
+            fgets(temp_buffer, sizeof(temp_buffer), stdin);
+            temp_buffer[strcspn(temp_buffer, "\n")] = 0;
+            old.reviewer_name = set_review_name(index, allocate_string(temp_buffer));
+            
+            do {
+                printf("Enter new satisfaction score (1-5): ");
+                scanf("%d", &temp_score);
+                getchar();
+            } while (temp_score < 1 || temp_score > 5);
+            old.satisfaction_score = set_review_score(index, temp_score);
+            
+            printf("Enter new review date (YYYY-MM-DD): ");
+            fgets(temp_buffer, sizeof(temp_buffer), stdin);
+            temp_buffer[strcspn(temp_buffer, "\n")] = 0;
+            old.review_date = set_review_date(index, allocate_string(temp_buffer));
+            
+            printf("Enter new feedback: ");
+            fgets(temp_buffer, sizeof(temp_buffer), stdin);
+            temp_buffer[strcspn(temp_buffer, "\n")] = 0;
+            old.feedback = set_review_feedback(index, allocate_string(temp_buffer));
+            
+            printf("✅ All fields updated!\n");
+            break;
+            
+        default:
+            printf("Invalid choice!\n");
+            return;
+    }
+    undo_record(UNDO_UPDATE, &index, 1, old);
+    wal_log_update(index);
+}
+
+void display_full_review(int index) {
+    if (index < 0 || index >= review_count) {
+        printf("Invalid review index!\n");
+        return;
+    }
+    
+    Review review = get_review(index);
+    
+    printf("\n╔════════════════════════════════════════╗\n");
+    printf("║           Review Details               ║\n");
+    printf("╚════════════════════════════════════════╝\n");
+    printf("Reviewer:  %s\n", review.reviewer_name);
+    printf("Score:     %d/5 ", review.satisfaction_score);
+    for (int i = 0; i < review.satisfaction_score; i++) printf("⭐");
+    printf("\n");
+    printf("Date:      %s\n", review.review_date);
+    printf("Feedback:  %s\n", review.feedback);
+    printf("────────────────────────────────────────\n");
+}
+
+// search
+
+void enhanced_search_menu() {
+    printf("\n╔════════════════════════════════════════╗\n");
+    printf("║         🔍 Search Options              ║\n");
+    printf("╚════════════════════════════════════════╝\n");
+    printf("1. Search by name (with typo correction)\n");
+    printf("2. Search by score range\n");
+    printf("3. Search by date\n");
+    printf("4. Search by date range\n");
+    printf("5. Back to main menu\n");
+    printf("Choice: ");
+    
+    int choice;
+    scanf("%d", &choice);
+    getchar();
+    
+    switch(choice) {
+        case 1:
+            search_reviews();
+            break;
+        case 2: {
+            int min_score, max_score;
+            printf("Enter minimum score (1-5): ");
+            scanf("%d", &min_score);
+            printf("Enter maximum score (1-5): ");
+            scanf("%d", &max_score);
+            getchar();
+            
+            printf("\n=== Reviews with score %d-%d ===\n", min_score, max_score);
+            int found = 0;
+            for (int i = 0; i < review_count; i++) {
+                if (is_review_live(i) &&
+                    review_scores[i] >= min_score && 
+                    review_scores[i] <= max_score) {
+                    display_full_review(i);
+                    found++;
+                }
+            }
+            if (found == 0) printf("No reviews found in this range.\n");
+            else printf("\nFound %d reviews.\n", found);
+            break;
+        }
+        case 3: {
+            char search_date[20];
+            printf("Enter date (YYYY-MM-DD): ");
+            fgets(search_date, sizeof(search_date), stdin);
+            search_date[strcspn(search_date, "\n")] = 0;
+            
+            printf("\n=== Reviews on %s ===\n", search_date);
+            // Valid dates come from the date index (BE and CE alike), anything else is compared as text
+            int32_t search_key = pack_date(search_date);
+            int found = 0;
+            if (search_key) {
+                int32_t day = day_number(search_key);
+                int start;
+                int count = find_reviews_in_date_range(day, day, &start);
+                for (int i = 0; i < count; i++) {
+                    int row = date_index[start + i].row;
+                    if (!is_review_live(row)) continue;
+                    display_full_review(row);
+                    found++;
+                }
+            } else {
+                for (int i = 0; i < review_count; i++) {
+                    if (is_review_live(i) && strcmp(review_dates[i], search_date) == 0) {
+                        display_full_review(i);
+                        found++;
+                    }
+                }
+            }
+            if (found == 0) printf("No reviews found on this date.\n");
+            else printf("\nFound %d reviews.\n", found);
+            break;
+        }
+        case 4:
+            search_by_date_range();
+            break;
+        case 5:
+            return;
+        default:
+            printf("Invalid choice!\n");
+    }
+}
+
+// Either two dates or "last N days" (a plain number)
+void search_by_date_range() {
+    char input[20];
+    int32_t first_day, last_day;
+
+    printf("Enter start date (YYYY-MM-DD) or number of days back (e.g. 7): ");
+    fgets(input, sizeof(input), stdin);
+    input[strcspn(input, "\n")] = 0;
+    trim_whitespace(input);
+
+    char *endptr;
+    long days_back = strtol(input, &endptr, 10);
+    if (strlen(input) > 0 && *endptr == '\0') {
+        if (days_back < 1) {
+            printf("❌ Number of days must be at least 1.\n");
+            return;
+        }
+        last_day = today_day_number();
+        first_day = last_day - (int32_t)(days_back - 1);
+        printf("\n=== Reviews from the last %ld day(s) ===\n", days_back);
+    } else {
+        int32_t first_key = pack_date(input);
+        if (!first_key) {
+            printf("❌ Invalid date! Use YYYY-MM-DD.\n");
+            return;
+        }
+        char end_date[20];
+        printf("Enter end date (YYYY-MM-DD): ");
+        fgets(end_date, sizeof(end_date), stdin);
+        end_date[strcspn(end_date, "\n")] = 0;
+        trim_whitespace(end_date);
+        int32_t last_key = pack_date(end_date);
+        if (!last_key) {
+            printf("❌ Invalid date! Use YYYY-MM-DD.\n");
+            return;
+        }
+        first_day = day_number(first_key);
+        last_day = day_number(last_key);
+        printf("\n=== Reviews from %s to %s ===\n", input, end_date);
+    }
+
+    int start;
+    int count = find_reviews_in_date_range(first_day, last_day, &start);
+    int found = 0;
+    for (int i = 0; i < count; i++) {
+        int row = date_index[start + i].row;
+        if (!is_review_live(row)) continue;
+        display_full_review(row);
+        found++;
+    }
+    if (found == 0) printf("No reviews found in this range.\n");
+    else printf("\nFound %d reviews.\n", found);
+}
+
+// Day number of the local date today
+int32_t today_day_number() {
+    time_t now = time(NULL);
+    struct tm *t = localtime(&now);
+    int32_t packed = (t->tm_year + 1900) * 10000 + (t->tm_mon + 1) * 100 + t->tm_mday;
+    return day_number(packed);
+}
+
+void search_reviews() {
+    char query[100];
+
+    printf("\n╔════════════════════════════════════════╗\n");
+    printf("║        🔍 Search Reviews               ║\n");
+    printf("╚════════════════════════════════════════╝\n");
+    printf("Enter reviewer name: ");
+    fgets(query, sizeof(query), stdin);
+    query[strcspn(query, "\n")] = 0;
+    
+    if (strlen(query) == 0) {
+        printf("Search cancelled.\n");
+        return;
+    }
+    
+    printf("\n🔎 Searching for: '%s'\n", query);
+    printf("────────────────────────────────────────\n");
+    
+    int resultCount, totalCount;
+    SearchResult* results = searchWithTypoCorrectionTopK(query, &resultCount, 3, SEARCH_SCREEN_RESULTS, &totalCount);
+    int partialIndices[MAX_PARTIAL_RESULTS];
+    int partialCount = find_partial_matches(query, partialIndices, MAX_PARTIAL_RESULTS);
+    
+    if (resultCount == 0 && partialCount == 0) {
+        printf("❌ No matches found.\n");
+        printf("\n💡 Tips:\n");
+        printf("  • Check spelling\n");
+        printf("  • Try shorter search term\n");
+        printf("  • Use partial name\n");
+        free(results);
+        return;
+    }
+    
+    int exactCount = 0, closeCount = 0, fuzzyCount = 0;
+    
+    for (int i = 0; i < resultCount; i++) {
+        if (strcmp(results[i].matchType, "exact") == 0) exactCount++;
+        else if (strcmp(results[i].matchType, "close") == 0) closeCount++;
+        else fuzzyCount++;
+    }
+    
+    // Display exact matches
+    if (exactCount > 0) {
+        printf("\n✅ Exact Matches (%d):\n", exactCount);
+        for (int i = 0; i < resultCount; i++) {
+            if (strcmp(results[i].matchType, "exact") == 0) {
+                int idx = results[i].index;
+                printf("  %d. %s (Score: %d/5, Date: %s)\n",
+                       live_rank(idx) + 1,
+                       review_names[idx],
+                       review_scores[idx],
+                       review_dates[idx]);
+                printf("     💬 %s\n", review_feedbacks[idx]);
+            }
+        }
+    }
+    
+    // Display close matches
+    if (closeCount > 0) {
+        printf("\n🔍 Close Matches (%d) - Did you mean?\n", closeCount);
+        for (int i = 0; i < resultCount; i++) {
+            if (strcmp(results[i].matchType, "close") == 0) {
+                int idx = results[i].index;
+                printf("  %d. %s (Edit distance: %d)\n",
+                       live_rank(idx) + 1,
+                       review_names[idx],
+                       results[i].distance);
+                printf("     Score: %d/5 | Date: %s\n",
+                       review_scores[idx],
+                       review_dates[idx]);
+            }
+        }
+    }
+    
+    // Display fuzzy matches
+    if (fuzzyCount > 0) {
+        printf("\n💡 Similar Names (%d):\n", fuzzyCount);
+        for (int i = 0; i < resultCount; i++) {
+            if (strcmp(results[i].matchType, "fuzzy") == 0) {
+                int idx = results[i].index;
+                printf("  %d. %s (Distance: %d)\n",
+                       live_rank(idx) + 1,
+                       review_names[idx],
+                       results[i].distance);
+            }
+        }
+    }
+    
+    if (totalCount > resultCount) {
+        printf("\n… %d more match(es) not shown, type more of the name to narrow it down.\n",
+               totalCount - resultCount);
+    }
+    
+    // Display names that contain the query, skipping rows already listed
+    if (partialCount > 0) {
+        char *shown = calloc(review_count, 1);
+        if (shown) {
+            for (int i = 0; i < resultCount; i++) shown[results[i].index] = 1;
+        }
+        int newCount = 0;
+        for (int i = 0; i < partialCount; i++) {
+            if (!shown || !shown[partialIndices[i]]) partialIndices[newCount++] = partialIndices[i];
+        }
+        if (newCount > 0) {
+            printf("\n🧩 Partial Matches (%d):\n", newCount);
+            for (int i = 0; i < newCount; i++) {
+                int idx = partialIndices[i];
+                printf("  %d. %s (Score: %d/5, Date: %s)\n",
+                       live_rank(idx) + 1,
+                       review_names[idx],
+                       review_scores[idx],
+                       review_dates[idx]);
+            }
+        }
+        free(shown);
+    }
+    
+    free(results);
+}
+
+SearchResult* searchWithTypoCorrection(const char* query, int* resultCount, int maxDistance) {
+    return searchWithTypoCorrectionTopK(query, resultCount, maxDistance, review_count, NULL);
+}
+
+/**
+ * The best 'limit' matches for query, sorted by distance and then table order
+ * (the same rows and order as the first 'limit' of a full search).
+ * Memory is O(limit) whatever the number of matches: hits go through a
+ * bounded heap instead of a list of every match.
+ * totalMatches (may be NULL) gets the number of matches before the cut.
+ * The caller frees the returned array.
+ */
+SearchResult* searchWithTypoCorrectionTopK(const char* query, int* resultCount, int maxDistance, int limit, int* totalMatches) {
+    *resultCount = 0;
+    if (totalMatches) *totalMatches = 0;
+    if (!query || review_count == 0 || limit <= 0) {
+        return NULL;
+    }
+
+    char* lowerQuery = toLowerCase(query);
+    if (!lowerQuery) {
+        return NULL;
+    }
+    
+    // find match: only the part of the name tree within maxDistance is visited
+    ResultBuffer found = {NULL, 0, 0, limit, 0};
+    if (!bk_built) bk_build();
+    int threads = search_thread_count();
+    if (threads > 1 && bk_node_count >= PARALLEL_MIN_NODES) {
+        bk_search_parallel(lowerQuery, maxDistance, threads, &found);
+    } else if (bk_node_count > 0) {
+        bk_search(0, lowerQuery, maxDistance, offer_result, &found);
+    }
+    free(lowerQuery);
+
+    SearchResult* results = found.items;
+    *resultCount = found.count;
+    if (totalMatches) *totalMatches = found.total;
+
+    for (int i = 0; i < *resultCount; i++) {
+        int distance = results[i].distance;
+        if (distance == 0) {
+            strcpy(results[i].matchType, "exact");
+        } else if (distance == 2) {
+            strcpy(results[i].matchType, "close");
+        } else {
+            strcpy(results[i].matchType, "fuzzy");
+        }
+    }
+
+    // result sorted by distance from (best matches first), ties in table order
+    // (so the order doesn't depend on which thread found what)
+    if (*resultCount > 1) {
+        qsort(results, *resultCount, sizeof(SearchResult), compare_search_results);
+    }
+    return results;
+}
+
+// Stream every match to callback as the name tree is walked (tree order, not
+// sorted), on the calling thread and without allocating per match.
+// The callback can end the search early by returning nonzero.
+void searchWithTypoCorrectionEach(const char* query, int maxDistance, SearchCallback callback, void *context) {
+    if (!query || !callback || review_count == 0) return;
+
+    char* lowerQuery = toLowerCase(query);
+    if (!lowerQuery) return;
+
+    if (!bk_built) bk_build();
+    if (bk_node_count > 0) {
+        bk_search(0, lowerQuery, maxDistance, callback, context);
+    }
+    free(lowerQuery);
+}
+
+// exact name index (hash)
+// Reviewer name (case-sensitive, as stored) -> the rows that carry it.
+// Open addressing with linear probing, built on the first exact lookup and
+// then kept in step by the table like the BK-tree. Entries whose rows are all
+// gone stay in the table, a later review by the same name reuses them.
+
+// FNV-1a
+uint32_t hash_name(const char *name) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char*)name; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+NameEntry* name_lookup(const char *name, int create) {
+    if (name_table_size == 0) {
+        if (!create) return NULL;
+        name_table_size = 1024;
+        name_table = calloc(name_table_size, sizeof(NameEntry));
+        if (!name_table) {
+            printf("Memory allocation failed!\n");
+            exit(1);
+        }
+    }
+
+    uint32_t hash = hash_name(name);
+    size_t mask = name_table_size - 1;
+    size_t slot = hash & mask;
+    while (name_table[slot].name != NULL) {
+        if (name_table[slot].hash == hash && strcmp(name_table[slot].name, name) == 0) {
+            return &name_table[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    if (!create) return NULL;
+
+    // Keep the table at most half full so probes stay short
+    if ((name_table_used + 1) * 2 > name_table_size) {
+        name_grow_table();
+        return name_lookup(name, create);
+    }
+    NameEntry *entry = &name_table[slot];
+    entry->name = allocate_string(name);
+    entry->hash = hash;
+    name_table_used++;
+    return entry;
+}
+
+void name_grow_table() {
+    NameEntry *old_table = name_table;
+    int old_size = name_table_size;
+
+    name_table_size *= 2;
+    name_table = calloc(name_table_size, sizeof(NameEntry));
+    if (!name_table) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+
+    size_t mask = name_table_size - 1;
+    for (int i = 0; i < old_size; i++) {
+        if (old_table[i].name == NULL) continue;
+        size_t slot = old_table[i].hash & mask;
+        while (name_table[slot].name != NULL) slot = (slot + 1) & mask;
+        name_table[slot] = old_table[i];
+    }
+    free(old_table);
+}
+
+void name_index_build() {
+    name_index_built = 1;
+    for (int i = 0; i < review_count; i++) {
+        name_index_add_row(review_names[i], i);
+    }
+}
+
+void name_index_add_row(const char *name, int row) {
+    NameEntry *entry = name_lookup(name, 1);
+    if (entry->row_count >= entry->row_capacity) {
+        entry->row_capacity = entry->row_capacity ? entry->row_capacity * 2 : 4;
+        entry->rows = realloc(entry->rows, entry->row_capacity * sizeof(int));
+        if (!entry->rows) {
+            printf("Memory reallocation failed!!\n");
+            exit(1);
+        }
+    }
+    entry->rows[entry->row_count++] = row;
+}
+
+void name_index_remove_row(const char *name, int row) {
+    NameEntry *entry = name_lookup(name, 0);
+    if (!entry) return;
+
+    for (int i = 0; i < entry->row_count; i++) {
+        if (entry->rows[i] == row) {
+            entry->rows[i] = entry->rows[--entry->row_count];
+            return;
+        }
+    }
+}
+
+// Renumber every row after a compaction, rows mapped to -1 are dropped
+void name_index_remap_rows(const int *new_row) {
+    for (int i = 0; i < name_table_size; i++) {
+        NameEntry *entry = &name_table[i];
+        int kept = 0;
+        for (int r = 0; r < entry->row_count; r++) {
+            int row = new_row[entry->rows[r]];
+            if (row >= 0) entry->rows[kept++] = row;
+        }
+        entry->row_count = kept;
+    }
+}
+
+// Rows of every review by exactly this name (unordered, deleted rows that are
+// not compacted yet included), NULL if there are none
+const int* find_rows_by_name(const char *name, int *count) {
+    *count = 0;
+    if (!name) return NULL;
+    if (!name_index_built) name_index_build();
+
+    NameEntry *entry = name_lookup(name, 0);
+    if (!entry || entry->row_count == 0) return NULL;
+    *count = entry->row_count;
+    return entry->rows;
+}
+
+void name_index_free() {
+    for (int i = 0; i < name_table_size; i++) {
+        release_string(name_table[i].name);
+        free(name_table[i].rows);
+    }
+    free(name_table);
+    name_table = NULL;
+    name_table_size = 0;
+    name_table_used = 0;
+    name_index_built = 0;
+}
+
+// date index
+// (day number, row) pairs sorted by day then row, so a date range is one
+// binary search plus a walk over the matching entries. Day numbers count from
+// 1970-01-01 and BE years are converted to CE first, so "2568-12-10" and
+// "2025-12-10" are the same day. Rows with an invalid date are left out.
+// Built on the first date search, then kept in step by the table.
+
+// Days since 1970-01-01 for a packed YYYYMMDD key (see pack_date)
+int32_t day_number(int32_t packed_date) {
+    int year = packed_date / 10000;
+    int month = packed_date / 100 % 100;
+    int day = packed_date % 100;
+    if (year >= 2400) year -= 543;  // Buddhist Era
+
+    // Count years from March so the leap day is the last day of the year
+    if (month <= 2) year--;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int year_of_era = year - era * 400;
+    int day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    int day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+// Fill then sort once, inserting row by row would be quadratic on unsorted dates
+void date_index_build() {
+    date_index_built = 1;
+    date_index_capacity = review_count > 64 ? review_count : 64;
+    date_index = malloc(date_index_capacity * sizeof(DateEntry));
+    if (!date_index) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+
+    date_index_count = 0;
+    for (int i = 0; i < review_count; i++) {
+        if (review_date_keys[i] == 0) continue;
+        date_index[date_index_count].day = day_number(review_date_keys[i]);
+        date_index[date_index_count].row = i;
+        date_index_count++;
+    }
+    qsort(date_index, date_index_count, sizeof(DateEntry), compare_date_entries);
+}
+
+int compare_date_entries(const void *a, const void *b) {
+    const DateEntry *x = a, *y = b;
+    if (x->day != y->day) return (x->day > y->day) - (x->day < y->day);
+    return (x->row > y->row) - (x->row < y->row);
+}
+
+// First entry that sorts at or after (day, row)
+int date_index_lower_bound(int32_t day, int row) {
+    int low = 0, high = date_index_count;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (date_index[mid].day < day || (date_index[mid].day == day && date_index[mid].row < row)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+void date_index_add_row(int row) {
+    if (review_date_keys[row] == 0) return;
+    int32_t day = day_number(review_date_keys[row]);
+
+    if (date_index_count >= date_index_capacity) {
+        date_index_capacity = date_index_capacity ? date_index_capacity * 2 : 64;
+        date_index = realloc(date_index, date_index_capacity * sizeof(DateEntry));
+        if (!date_index) {
+            printf("Memory reallocation failed!!\n");
+            exit(1);
+        }
+    }
+
+    // Loading appends rows in date order often enough that the end is worth a look
+    int pos = date_index_count;
+    if (pos > 0 && (date_index[pos - 1].day > day ||
+                    (date_index[pos - 1].day == day && date_index[pos - 1].row > row))) {
+        pos = date_index_lower_bound(day, row);
+        memmove(&date_index[pos + 1], &date_index[pos], (date_index_count - pos) * sizeof(DateEntry));
+    }
+    date_index[pos].day = day;
+    date_index[pos].row = row;
+    date_index_count++;
+}
+
+// Call before the row's date key changes
+void date_index_remove_row(int row) {
+    if (review_date_keys[row] == 0) return;
+    int32_t day = day_number(review_date_keys[row]);
+
+    int pos = date_index_lower_bound(day, row);
+    if (pos < date_index_count && date_index[pos].day == day && date_index[pos].row == row) {
+        memmove(&date_index[pos], &date_index[pos + 1], (date_index_count - pos - 1) * sizeof(DateEntry));
+        date_index_count--;
+    }
+}
+
+// Renumber every row after a compaction, rows mapped to -1 are dropped.
+// Compaction keeps the row order, so the entries stay sorted.
+void date_index_remap_rows(const int *new_row) {
+    int kept = 0;
+    for (int i = 0; i < date_index_count; i++) {
+        int row = new_row[date_index[i].row];
+        if (row < 0) continue;
+        date_index[kept].day = date_index[i].day;
+        date_index[kept].row = row;
+        kept++;
+    }
+    date_index_count = kept;
+}
+
+// Reviews dated first_day..last_day (inclusive) are date_index[*start] onwards,
+// in date order. Returns how many entries that is, deleted rows included.
+int find_reviews_in_date_range(int32_t first_day, int32_t last_day, int *start) {
+    if (!date_index_built) date_index_build();
+
+    *start = date_index_lower_bound(first_day, -1);
+    if (last_day < first_day) return 0;
+    int end = date_index_lower_bound(last_day + 1, -1);
+    return end - *start;
+}
+
+void date_index_free() {
+    free(date_index);
+    date_index = NULL;
+    date_index_count = 0;
+    date_index_capacity = 0;
+    date_index_built = 0;
+}
+
+// name index (BK-tree)
+// One node per distinct lowercase name. A child hangs off its parent by their
+// edit distance, so by the triangle inequality a search for names within d of
+// the query only has to follow child edges in [k - d, k + d] (k = distance to
+// the node). Built on the first name search, then kept in step by the table.
+
+void bk_build() {
+    bk_built = 1;
+    for (int i = 0; i < review_count; i++) {
+        bk_add_row(review_names[i], i);
+    }
+    bk_reorder();
+}
+
+// Renumber nodes breadth-first so each node's children (and their keys)
+// sit next to each other, a search then walks memory mostly in order
+void bk_reorder() {
+    if (bk_node_count == 0) return;
+
+    BKNode *ordered = malloc(bk_node_capacity * sizeof(BKNode));
+    int *new_id = malloc(bk_node_count * sizeof(int));
+    if (!ordered || !new_id) {
+        free(ordered);
+        free(new_id);
+        return; // keep the old order, it still works
+    }
+
+    // BFS: the queue is 'ordered' itself, children are appended in sibling order
+    ordered[0] = bk_nodes[0];
+    new_id[0] = 0;
+    int tail = 1;
+    for (int head = 0; head < tail; head++) {
+        for (int child = ordered[head].first_child; child >= 0; child = bk_nodes[child].next_sibling) {
+            new_id[child] = tail;
+            ordered[tail++] = bk_nodes[child];
+        }
+    }
+
+    // Fix the links and copy the keys into one fresh run of pool memory
+    for (int n = 0; n < bk_node_count; n++) {
+        BKNode *node = &ordered[n];
+        if (node->first_child >= 0) node->first_child = new_id[node->first_child];
+        if (node->next_sibling >= 0) node->next_sibling = new_id[node->next_sibling];
+        node->key = allocate_string(node->key);
+    }
+    // Old keys go back only now, or the copies above would reuse their scattered blocks
+    for (int n = 0; n < bk_node_count; n++) {
+        release_string(bk_nodes[n].key);
+    }
+
+    free(bk_nodes);
+    free(new_id);
+    bk_nodes = ordered;
+}
+
+void bk_add_row(const char *name, int row) {
+    char *key = allocate_folded(name);
+
+    int node = bk_node_count > 0 ? 0 : -1;
+    int parent = -1;
+    int distance = 0;
+    while (node >= 0) {
+        distance = editDistance(key, bk_nodes[node].key);
+        if (distance == 0) break;
+
+        // Walk down the edge with the same distance, or hang a new node there
+        parent = node;
+        node = -1;
+        for (int child = bk_nodes[parent].first_child; child >= 0; child = bk_nodes[child].next_sibling) {
+            if (bk_nodes[child].edge == distance) {
+                node = child;
+                break;
+            }
+        }
+    }
+
+    if (node < 0) {
+        if (bk_node_count >= bk_node_capacity) {
+            bk_node_capacity = bk_node_capacity ? bk_node_capacity * 2 : 64;
+            bk_nodes = realloc(bk_nodes, bk_node_capacity * sizeof(BKNode));
+            if (!bk_nodes) {
+                printf("Memory reallocation failed!!\n");
+                exit(1);
+            }
+        }
+        node = bk_node_count++;
+        BKNode *new_node = &bk_nodes[node];
+        new_node->key = key;
+        new_node->rows = NULL;
+        new_node->row_count = 0;
+        new_node->row_capacity = 0;
+        new_node->edge = distance;
+        new_node->max_child_edge = 0;
+        new_node->first_child = -1;
+        new_node->next_sibling = -1;
+        if (parent >= 0) {
+            new_node->next_sibling = bk_nodes[parent].first_child;
+            bk_nodes[parent].first_child = node;
+            if (distance > bk_nodes[parent].max_child_edge) {
+                bk_nodes[parent].max_child_edge = distance;
+            }
+        }
+        if (tri_built) tri_add_node(node);
+    } else {
+        release_string(key);
+    }
+
+    BKNode *target = &bk_nodes[node];
+    if (target->row_count >= target->row_capacity) {
+        target->row_capacity = target->row_capacity ? target->row_capacity * 2 : 4;
+        target->rows = realloc(target->rows, target->row_capacity * sizeof(int));
+        if (!target->rows) {
+            printf("Memory reallocation failed!!\n");
+            exit(1);
+        }
+    }
+    target->rows[target->row_count++] = row;
+}
+
+// Nodes are never unlinked, a node with no rows left just routes searches
+void bk_remove_row(const char *name, int row) {
+    int node = bk_find_node(name);
+    if (node < 0) return;
+
+    BKNode *target = &bk_nodes[node];
+    for (int i = 0; i < target->row_count; i++) {
+        if (target->rows[i] == row) {
+            target->rows[i] = target->rows[--target->row_count];
+            return;
+        }
+    }
+}
+
+int bk_find_node(const char *name) {
+    char *key = allocate_folded(name);
+
+    int node = bk_node_count > 0 ? 0 : -1;
+    while (node >= 0) {
+        int distance = editDistance(key, bk_nodes[node].key);
+        if (distance == 0) break;
+
+        int next = -1;
+        for (int child = bk_nodes[node].first_child; child >= 0; child = bk_nodes[child].next_sibling) {
+            if (bk_nodes[child].edge == distance) {
+                next = child;
+                break;
+            }
+        }
+        node = next;
+    }
+    release_string(key);
+    return node;
+}
+
+// Renumber every row after a compaction, rows mapped to -1 are dropped
+void bk_remap_rows(const int *new_row) {
+    for (int n = 0; n < bk_node_count; n++) {
+        int kept = 0;
+        for (int i = 0; i < bk_nodes[n].row_count; i++) {
+            int row = new_row[bk_nodes[n].rows[i]];
+            if (row >= 0) bk_nodes[n].rows[kept++] = row;
+        }
+        bk_nodes[n].row_count = kept;
+    }
+}
+
+// Check one node: pass its rows to emit if its name is within maxDistance.
+// Returns the node's distance, BK_PRUNED or BK_STOPPED.
+int bk_visit(int node, const char *lower_query, int maxDistance, SearchCallback emit, void *context) {
+    BKNode *current = &bk_nodes[node];
+
+    // Past this bound neither the node nor any child edge can qualify
+    int bound = current->max_child_edge + maxDistance;
+    int distance = editDistanceWithin(lower_query, current->key, bound);
+
+    if (distance <= maxDistance) {
+        for (int i = 0; i < current->row_count; i++) {
+            if (!is_review_live(current->rows[i])) continue;
+            if (emit(current->rows[i], distance, context)) return BK_STOPPED;
+        }
+    }
+    return distance > bound ? BK_PRUNED : distance;
+}
+
+// Pass every row whose name is within maxDistance of lower_query to emit
+// Returns 1 if emit stopped the search
+int bk_search(int node, const char *lower_query, int maxDistance, SearchCallback emit, void *context) {
+    int distance = bk_visit(node, lower_query, maxDistance, emit, context);
+    if (distance == BK_STOPPED) return 1;
+    if (distance == BK_PRUNED) return 0;
+
+    for (int child = bk_nodes[node].first_child; child >= 0; child = bk_nodes[child].next_sibling) {
+        int edge = bk_nodes[child].edge;
+        if (edge >= distance - maxDistance && edge <= distance + maxDistance) {
+            if (bk_search(child, lower_query, maxDistance, emit, context)) return 1;
+        }
+    }
+    return 0;
+}
+
+// Same result as bk_search(0, ...) but the subtrees are shared out over the
+// thread pool. The top of the tree is walked here breadth-first until there
+// are enough open subtrees to keep every thread busy.
+void bk_search_parallel(const char *lower_query, int maxDistance, int threads, ResultBuffer *out) {
+    threads = workers_start(threads);
+
+    int capacity = threads * TASKS_PER_THREAD * 2;
+    int *queue = malloc(capacity * sizeof(int));
+    ResultBuffer *buffers = calloc(threads, sizeof(ResultBuffer));
+    if (!queue || !buffers) {
+        free(queue);
+        free(buffers);
+        bk_search(0, lower_query, maxDistance, offer_result, out);
+        return;
+    }
+    for (int w = 0; w < threads; w++) {
+        buffers[w].limit = out->limit;
+    }
+
+    int head = 0, tail = 0;
+    queue[tail++] = 0;
+    while (head < tail && tail - head < threads * TASKS_PER_THREAD) {
+        int node = queue[head++];
+        int distance = bk_visit(node, lower_query, maxDistance, offer_result, out);
+        if (distance < 0) continue;
+
+        for (int child = bk_nodes[node].first_child; child >= 0; child = bk_nodes[child].next_sibling) {
+            int edge = bk_nodes[child].edge;
+            if (edge < distance - maxDistance || edge > distance + maxDistance) continue;
+            if (tail >= capacity) {
+                capacity *= 2;
+                queue = realloc(queue, capacity * sizeof(int));
+                if (!queue) {
+                    printf("Memory reallocation failed!!\n");
+                    exit(1);
+                }
+            }
+            queue[tail++] = child;
+        }
+    }
+
+    BKSearchJob job = {queue + head, lower_query, maxDistance, buffers};
+    workers_run(bk_search_task, &job, tail - head);
+
+    // Each worker kept its own best 'limit', the best of those are the answer
+    for (int w = 0; w < threads; w++) {
+        for (int i = 0; i < buffers[w].count; i++) {
+            offer_result(buffers[w].items[i].index, buffers[w].items[i].distance, out);
+        }
+        out->total += buffers[w].total - buffers[w].count;
+        free(buffers[w].items);
+    }
+    free(buffers);
+    free(queue);
+}
+
+void bk_search_task(int task, int worker, void *arg) {
+    BKSearchJob *job = arg;
+    bk_search(job->nodes[task], job->lower_query, job->maxDistance, offer_result, &job->buffers[worker]);
+}
+
+// SearchCallback that keeps the best out->limit hits in the heap
+int offer_result(int index, int distance, void *context) {
+    ResultBuffer *out = context;
+    out->total++;
+
+    SearchResult hit;
+    hit.index = index;
+    hit.distance = distance;
+
+    if (out->count < out->limit) {
+        if (out->count >= out->capacity) {
+            out->capacity = out->capacity ? out->capacity * 2 : 64;
+            if (out->capacity > out->limit) out->capacity = out->limit;
+            out->items = realloc(out->items, out->capacity * sizeof(SearchResult));
+            if (!out->items) {
+                printf("Memory reallocation failed!!\n");
+                exit(1);
+            }
+        }
+        // Sift up from the new leaf
+        int slot = out->count++;
+        while (slot > 0) {
+            int parent = (slot - 1) / 2;
+            if (compare_search_results(&out->items[parent], &hit) >= 0) break;
+            out->items[slot] = out->items[parent];
+            slot = parent;
+        }
+        out->items[slot] = hit;
+    } else if (compare_search_results(&hit, &out->items[0]) < 0) {
+        out->items[0] = hit;
+        result_heap_down(out, 0);
+    }
+    return 0;
+}
+
+void result_heap_down(ResultBuffer *out, int slot) {
+    SearchResult moving = out->items[slot];
+    for (;;) {
+        int child = slot * 2 + 1;
+        if (child >= out->count) break;
+        if (child + 1 < out->count && compare_search_results(&out->items[child + 1], &out->items[child]) > 0) {
+            child++;
+        }
+        if (compare_search_results(&out->items[child], &moving) <= 0) break;
+        out->items[slot] = out->items[child];
+        slot = child;
+    }
+    out->items[slot] = moving;
+}
+
+// search thread pool
+// Workers are started on the first parallel search and then sleep between
+// jobs. A job is a number of tasks, the caller works on it too (as worker 0)
+// and every thread takes the next task from a shared counter until none are
+// left, so a few slow subtrees don't hold up the others.
+
+// Threads for a name search: REVIEW_THREADS if set, otherwise one per online CPU
+int search_thread_count() {
+    if (search_threads > 0) return search_threads;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) return 1;
+    return cpus > MAX_SEARCH_THREADS ? MAX_SEARCH_THREADS : (int)cpus;
+}
+
+// Start threads - 1 workers, returns how many threads a job will get
+int workers_start(int threads) {
+    if (worker_count > 0) return worker_count;
+
+    worker_threads = malloc(threads * sizeof(pthread_t));
+    if (!worker_threads) return 1;
+
+    workers_stopping = 0;
+    worker_count = 1;  // the calling thread
+    for (int i = 1; i < threads; i++) {
+        if (pthread_create(&worker_threads[i], NULL, worker_main, (void*)(intptr_t)i) != 0) {
+            break;  // run with the ones we have
+        }
+        worker_count++;
+    }
+    return worker_count;
+}
+
+void* worker_main(void *arg) {
+    int id = (int)(intptr_t)arg;
+    unsigned seen = 0;
+
+    pthread_mutex_lock(&workers_lock);
+    for (;;) {
+        while (!workers_stopping && workers_generation == seen) {
+            pthread_cond_wait(&workers_wake, &workers_lock);
+        }
+        if (workers_stopping) break;
+        seen = workers_generation;
+        pthread_mutex_unlock(&workers_lock);
+
+        workers_drain(id);
+
+        pthread_mutex_lock(&workers_lock);
+        if (--workers_active == 0) pthread_cond_signal(&workers_done);
+    }
+    pthread_mutex_unlock(&workers_lock);
+
+    myers_free_scratch();  // this thread's copy
+    return NULL;
+}
+
+void workers_drain(int worker) {
+    for (;;) {
+        int task = __atomic_fetch_add(&workers_next_task, 1, __ATOMIC_RELAXED);
+        if (task >= workers_task_count) break;
+        workers_job(task, worker, workers_job_arg);
+    }
+}
+
+// Run job(task, worker, arg) for every task in 0..task_count-1, returns when all are done
+void workers_run(void (*job)(int task, int worker, void *arg), void *arg, int task_count) {
+    pthread_mutex_lock(&workers_lock);
+    workers_job = job;
+    workers_job_arg = arg;
+    workers_task_count = task_count;
+    workers_next_task = 0;
+    workers_active = worker_count - 1;
+    workers_generation++;
+    pthread_cond_broadcast(&workers_wake);
+    pthread_mutex_unlock(&workers_lock);
+
+    workers_drain(0);
+
+    pthread_mutex_lock(&workers_lock);
+    while (workers_active > 0) {
+        pthread_cond_wait(&workers_done, &workers_lock);
+    }
+    pthread_mutex_unlock(&workers_lock);
+}
+
+void workers_stop() {
+    if (worker_count == 0) return;
+
+    pthread_mutex_lock(&workers_lock);
+    workers_stopping = 1;
+    pthread_cond_broadcast(&workers_wake);
+    pthread_mutex_unlock(&workers_lock);
+
+    for (int i = 1; i < worker_count; i++) {
+        pthread_join(worker_threads[i], NULL);
+    }
+    free(worker_threads);
+    worker_threads = NULL;
+    worker_count = 0;
+}
+
+void bk_free() {
+    tri_free();  // the trigram index points at BK nodes
+    for (int n = 0; n < bk_node_count; n++) {
+        release_string(bk_nodes[n].key);
+        free(bk_nodes[n].rows);
+    }
+    free(bk_nodes);
+    bk_nodes = NULL;
+    bk_node_count = 0;
+    bk_node_capacity = 0;
+    bk_built = 0;
+}
+
+// partial name index (trigrams)
+// Every distinct name in the BK-tree is split into words padded like
+// "  john " and each 3-byte window is a trigram. The posting list of a trigram
+// holds the BK node ids of the names that contain it, in increasing order.
+
+// Edits allowed when the query only has to match part of a name
+int partial_tolerance(int query_length) {
+    if (query_length <= 3) return 0;
+    if (query_length <= 7) return 1;
+    return 2;
+}
+
+// Distinct trigrams of text into grams[], returns how many
+// interior (if not NULL) gets the number of windows that don't touch padding
+int collect_trigrams(const char *text, uint32_t *grams, int max_grams, int *interior) {
+    int count = 0;
+    if (interior) *interior = 0;
+
+    const char *p = text;
+    while (*p) {
+        while (*p == ' ') p++;
+        if (!*p) break;
+        const char *word = p;
+        while (*p && *p != ' ') p++;
+        int length = p - word;
+
+        // "  word " so the first letters and the end of a word get grams too
+        for (int i = -2; i < length - 1; i++) {
+            uint32_t c0 = i < 0 ? ' ' : (unsigned char)word[i];
+            uint32_t c1 = i + 1 < 0 ? ' ' : (unsigned char)word[i + 1];
+            uint32_t c2 = i + 2 < length ? (unsigned char)word[i + 2] : ' ';
+            uint32_t gram = TRIGRAM_USED | (c0 << 16) | (c1 << 8) | c2;
+            if (interior && i >= 0 && i + 2 < length) (*interior)++;
+
+            int seen = 0;
+            for (int g = 0; g < count; g++) {
+                if (grams[g] == gram) {
+                    seen = 1;
+                    break;
+                }
+            }
+            if (!seen && count < max_grams) grams[count++] = gram;
+        }
+    }
+    return count;
+}
+
+TrigramPosting* tri_lookup(uint32_t gram, int create) {
+    if (tri_table_size == 0) {
+        if (!create) return NULL;
+        tri_table_size = 1024;
+        tri_table = calloc(tri_table_size, sizeof(TrigramPosting));
+        if (!tri_table) {
+            printf("Memory allocation failed!\n");
+            exit(1);
+        }
+    }
+
+    size_t mask = tri_table_size - 1;
+    size_t slot = (gram * 2654435761u) & mask;
+    while (tri_table[slot].gram != 0) {
+        if (tri_table[slot].gram == gram) return &tri_table[slot];
+        slot = (slot + 1) & mask;
+    }
+    if (!create) return NULL;
+
+    // Keep the table at most half full so probes stay short
+    if ((tri_table_used + 1) * 2 > tri_table_size) {
+        tri_grow_table();
+        return tri_lookup(gram, create);
+    }
+    tri_table[slot].gram = gram;
+    tri_table_used++;
+    return &tri_table[slot];
+}
+
+void tri_grow_table() {
+    TrigramPosting *old_table = tri_table;
+    int old_size = tri_table_size;
+
+    tri_table_size *= 2;
+    tri_table = calloc(tri_table_size, sizeof(TrigramPosting));
+    if (!tri_table) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+
+    size_t mask = tri_table_size - 1;
+    for (int i = 0; i < old_size; i++) {
+        if (old_table[i].gram == 0) continue;
+        size_t slot = (old_table[i].gram * 2654435761u) & mask;
+        while (tri_table[slot].gram != 0) slot = (slot + 1) & mask;
+        tri_table[slot] = old_table[i];
+    }
+    free(old_table);
+}
+
+void tri_add_node(int node) {
+    uint32_t grams[MAX_NAME_TRIGRAMS];
+    int count = collect_trigrams(bk_nodes[node].key, grams, MAX_NAME_TRIGRAMS, NULL);
+
+    for (int g = 0; g < count; g++) {
+        TrigramPosting *posting = tri_lookup(grams[g], 1);
+        if (posting->count >= posting->capacity) {
+            posting->capacity = posting->capacity ? posting->capacity * 2 : 4;
+            posting->nodes = realloc(posting->nodes, posting->capacity * sizeof(int));
+            if (!posting->nodes) {
+                printf("Memory reallocation failed!!\n");
+                exit(1);
+            }
+        }
+        posting->nodes[posting->count++] = node;
+    }
+}
+
+// Index every name the BK-tree knows (builds the tree first if needed)
+void tri_build() {
+    if (!bk_built) bk_build();
+    tri_built = 1;
+    for (int node = 0; node < bk_node_count; node++) {
+        tri_add_node(node);
+    }
+}
+
+void tri_free() {
+    for (int i = 0; i < tri_table_size; i++) {
+        free(tri_table[i].nodes);
+    }
+    free(tri_table);
+    free(tri_overlap);
+    tri_table = NULL;
+    tri_overlap = NULL;
+    tri_table_size = 0;
+    tri_table_used = 0;
+    tri_overlap_size = 0;
+    tri_built = 0;
+}
+
+/**
+ * Reviews whose name contains search_term, allowing a typo or two
+ * ("jhon" finds "John Smith"). Fills found_indices with up to max_results
+ * review indices, best matches first, and returns how many it wrote.
+ * 1. Count shared trigrams per name from the posting lists
+ * 2. Names with at least min_overlap shared trigrams are verified with
+ *    partialDistanceWithin(). min_overlap comes from the q-gram lemma
+ *    (an edit breaks at most 3 trigrams, a swap 4). When it is 0 or less
+ *    a match may share no trigram at all, so every name is verified.
+ */
+int find_partial_matches(const char *search_term, int *found_indices, int max_results) {
+    if (!search_term || max_results <= 0 || review_count == 0) return 0;
+
+    char *query = allocate_folded(search_term);
+    trim_whitespace(query);
+    int length = strlen(query);
+    if (length == 0) {
+        release_string(query);
+        return 0;
+    }
+
+    if (!tri_built) tri_build();
+
+    if (tri_overlap_size < bk_node_count) {
+        int new_size = bk_node_capacity;
+        tri_overlap = realloc(tri_overlap, new_size * sizeof(uint16_t));
+        if (!tri_overlap) {
+            printf("Memory reallocation failed!!\n");
+            exit(1);
+        }
+        memset(tri_overlap + tri_overlap_size, 0, (new_size - tri_overlap_size) * sizeof(uint16_t));
+        tri_overlap_size = new_size;
+    }
+
+    int max_edits = partial_tolerance(length);
+    int interior;
+    uint32_t grams[MAX_NAME_TRIGRAMS];
+    int gram_count = collect_trigrams(query, grams, MAX_NAME_TRIGRAMS, &interior);
+    int min_overlap = interior - 4 * max_edits;
+    int check_all = min_overlap < 1;
+
+    // Count overlaps, remembering which names were touched so we can reset them
+    int touched_count = 0;
+    int touched_capacity = check_all && bk_node_count > 256 ? bk_node_count : 256;
+    int *touched = malloc(touched_capacity * sizeof(int));
+    if (!touched) {
+        release_string(query);
+        return 0;
+    }
+    if (check_all) {
+        for (int node = 0; node < bk_node_count; node++) touched[touched_count++] = node;
+        gram_count = 0;
+    }
+    for (int g = 0; g < gram_count; g++) {
+        TrigramPosting *posting = tri_lookup(grams[g], 0);
+        if (!posting) continue;
+        for (int i = 0; i < posting->count; i++) {
+            int node = posting->nodes[i];
+            if (tri_overlap[node]++ == 0) {
+                if (touched_count >= touched_capacity) {
+                    touched_capacity *= 2;
+                    touched = realloc(touched, touched_capacity * sizeof(int));
+                    if (!touched) {
+                        printf("Memory reallocation failed!!\n");
+                        exit(1);
+                    }
+                }
+                touched[touched_count++] = node;
+            }
+        }
+    }
+
+    // Verify the candidates and collect their rows
+    int match_count = 0, match_capacity = 64;
+    SearchResult *matches = malloc(match_capacity * sizeof(SearchResult));
+    for (int t = 0; t < touched_count && matches; t++) {
+        int node = touched[t];
+        int overlap = tri_overlap[node];
+        tri_overlap[node] = 0;
+        if (overlap < min_overlap || bk_nodes[node].row_count == 0) continue;
+
+        int distance = partialDistanceWithin(query, bk_nodes[node].key, max_edits);
+        if (distance > max_edits) continue;
+
+        for (int r = 0; r < bk_nodes[node].row_count; r++) {
+            if (!is_review_live(bk_nodes[node].rows[r])) continue;
+            if (match_count >= match_capacity) {
+                match_capacity *= 2;
+                matches = realloc(matches, match_capacity * sizeof(SearchResult));
+                if (!matches) break;
+            }
+            matches[match_count].index = bk_nodes[node].rows[r];
+            matches[match_count].distance = distance;
+            match_count++;
+        }
+    }
+    // A failed realloc above leaves some counters set, clear them all
+    for (int t = 0; t < touched_count; t++) tri_overlap[touched[t]] = 0;
+    free(touched);
+    release_string(query);
+    if (!matches) return 0;
+
+    qsort(matches, match_count, sizeof(SearchResult), compare_search_results);
+    int found = match_count < max_results ? match_count : max_results;
+    for (int i = 0; i < found; i++) {
+        found_indices[i] = matches[i].index;
+    }
+    free(matches);
+    return found;
+}
+
+int compare_search_results(const void *a, const void *b) {
+    const SearchResult *left = a;
+    const SearchResult *right = b;
+    if (left->distance != right->distance) return left->distance - right->distance;
+    return left->index - right->index;
+}
+
+// delete
+
+void enhanced_delete_menu() {
+    printf("\n╔════════════════════════════════════════╗\n");
+    printf("║         🗑️  Delete Options             ║\n");
+    printf("╚════════════════════════════════════════╝\n");
+    printf("1. Delete by name\n");
+    printf("2. Delete by selecting from list\n");
+    printf("3. Delete all reviews by a user\n");
+    printf("4. Back to main menu\n");
+    printf("Choice: ");
+    
+    int choice;
+    scanf("%d", &choice);
+    getchar();
+    
+    switch(choice) {
+        case 1:
+            delete_review_by_name();
+            break;
+        case 2:
+            delete_by_selection();
+            break;
+        case 3:
+            delete_all_by_user();
+            break;
+        case 4:
+            return;
+        default:
+            printf("Invalid choice!\n");
+    }
+}
+
+void delete_review_by_name() {
+    if (live_review_count() == 0) {
+        printf("No reviews to delete.\n");
+        return;
+    }
+
+    char search_name[256];
+    printf("\n=== Delete Review ===\n");
+    printf("Enter reviewer name to delete: ");
+    fgets(search_name, sizeof(search_name), stdin);
+    search_name[strcspn(search_name, "\n")] = 0;
+
+    // Use typo correction to find matches (best screenful only)
+    int resultCount, totalCount;
+    SearchResult* results = searchWithTypoCorrectionTopK(search_name, &resultCount, 3, SEARCH_SCREEN_RESULTS, &totalCount);
+    
+    if (resultCount == 0) {
+        printf("Review not found!\n");
+        free(results);
+        return;
+    }
+    
+    // If multiple matches, show them
+    if (resultCount > 1) {
+        if (totalCount > resultCount) {
+            printf("\n%d matches found, showing the closest %d:\n", totalCount, resultCount);
+        } else {
+            printf("\nMultiple matches found:\n");
+        }
+        for (int i = 0; i < resultCount; i++) {
+            int idx = results[i].index;
+            printf("%d. %s (Score: %d/5, Date: %s)\n",
+                   i + 1,
+                   review_names[idx],
+                   review_scores[idx],
+                   review_dates[idx]);
+        }
+        printf("\nSelect review to delete (1-%d), or 0 to cancel: ", resultCount);
+        int choice;
+        scanf("%d", &choice);
+        getchar();
+        
+        if (choice < 1 || choice > resultCount) {
+            printf("Delete cancelled.\n");
+            free(results);
+            return;
+        }
+        
+        delete_review_at_index(results[choice - 1].index);
+    } else {
+        // Single match - confirm and delete
+        int idx = results[0].index;
+        printf("Found review:\n");
+        printf("Reviewer: %s\n", review_names[idx]);
+        printf("Score: %d/5\n", review_scores[idx]);
+        printf("Date: %s\n", review_dates[idx]);
+        printf("Feedback: %s\n", review_feedbacks[idx]);
+        
+        char confirm;
+        printf("Are you sure you want to delete this review? (y/n): ");
+        scanf(" %c", &confirm);
+        getchar();
+        
+        if (confirm == 'y' || confirm == 'Y') {
+            delete_review_at_index(idx);
+        } else {
+            printf("Deletion cancelled.\n");
+        }
+    }
+    
+    free(results);
+}
+
+void delete_by_selection() {
+    int live_count = live_review_count();
+    if (live_count == 0) {
+        printf("No reviews to delete.\n");
+        return;
+    }
+    
+    display_all_reviews();
+    
+    printf("\nEnter review number to delete (1-%d): ", live_count);
+    int choice;
+    scanf("%d", &choice);
+    getchar();
+    
+    if (choice < 1 || choice > live_count) {
+        printf("Invalid choice!\n");
+        return;
+    }
+    
+    delete_review_at_index(row_of_live_rank(choice - 1));
+}
+
+void delete_all_by_user() {
+    if (live_review_count() == 0) {
+        printf("No reviews to delete.\n");
+        return;
+    }
+    
+    char search_name[256];
+    printf("Enter reviewer name: ");
+    fgets(search_name, sizeof(search_name), stdin);
+    search_name[strcspn(search_name, "\n")] = 0;
+
+    int deleted_count = delete_reviews_by_name(search_name);
+    if (deleted_count > 0) {
+        printf("✅ Deleted %d review(s) by %s\n", deleted_count, search_name);
+        printf("💡 Tip: Use menu option 8 to undo if this was a mistake.\n");
+    } else {
+        printf("❌ No reviews found for %s\n", search_name);
+    }
+}
+
+// Delete every review by name (exact), returns how many went.
+// The index hands us the rows directly, each delete is a tombstone and
+// the whole batch is one undo step.
+int delete_reviews_by_name(const char *name) {
+    int row_count;
+    const int *rows = find_rows_by_name(name, &row_count);
+    int *deleted = malloc((row_count > 0 ? row_count : 1) * sizeof(int));
+    if (!deleted) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    int deleted_count = 0;
+    for (int i = 0; i < row_count; i++) {
+        if (!is_review_live(rows[i])) continue;
+        deleted[deleted_count++] = rows[i];
+    }
+    for (int i = 0; i < deleted_count; i++) {
+        kill_review_row(deleted[i]);
+    }
+    if (deleted_count > 0) {
+        Review unchanged = {NULL, -1, NULL, NULL};
+        undo_record(UNDO_DELETE, deleted, deleted_count, unchanged);
+        wal_log_delete(deleted, deleted_count);
+    }
+    free(deleted);
+    maybe_compact_reviews();
+    return deleted_count;
+}
+
+void delete_review_at_index(int index) {
+    if (index < 0 || index >= review_count || !is_review_live(index)) {
+        printf("Invalid index!\n");
+        return;
+    }
+    
+    printf("\n⚠️  You are about to delete:\n");
+    display_full_review(index);
+    
+    printf("\n❗ Type 'DELETE' to confirm: ");
+    char confirm[20];
+    scanf("%s", confirm);
+    getchar();
+    
+    if (strcmp(confirm, "DELETE") == 0) {
+        // The row stays in the table as a tombstone, undo just revives it
+        kill_review_row(index);
+        Review unchanged = {NULL, -1, NULL, NULL};
+        undo_record(UNDO_DELETE, &index, 1, unchanged);
+        wal_log_delete(&index, 1);
+        maybe_compact_reviews();
+        
+        printf("✅ Review deleted!\n");
+        printf("💡 Tip: Use menu option 8 to undo if this was a mistake.\n");
+    } else {
+        printf("❌ Deletion cancelled.\n");
+    }
+}
+
+// undo journal
+
+// Record a change that is already in the table. rows are copied, swap (for
+// UNDO_UPDATE) is taken over. Deleted rows get pinned so compaction keeps them.
+void undo_record(UndoKind kind, const int *rows, int row_count, Review swap) {
+    // A new change ends the redo history
+    while (undo_count > undo_position) {
+        undo_drop_entry(&undo_log[--undo_count], 0);
+    }
+
+    UndoEntry entry;
+    entry.kind = kind;
+    entry.rows = (int*)malloc(row_count * sizeof(int));
+    if (!entry.rows) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    memcpy(entry.rows, rows, row_count * sizeof(int));
+    entry.row_count = row_count;
+    entry.swap = swap;
+    entry.bytes = sizeof(UndoEntry) + row_count * sizeof(int);
+    if (kind == UNDO_DELETE) {
+        for (int i = 0; i < row_count; i++) {
+            set_review_pinned(rows[i], 1);
+            entry.bytes += review_bytes(rows[i]);
+        }
+    } else if (kind == UNDO_UPDATE) {
+        if (swap.reviewer_name) entry.bytes += strlen(swap.reviewer_name) + 1;
+        if (swap.review_date) entry.bytes += strlen(swap.review_date) + 1;
+        if (swap.feedback) entry.bytes += strlen(swap.feedback) + 1;
+    }
+    undo_bytes += entry.bytes;
+
+    if (undo_byte_limit == 0) {  // undo is off
+        undo_drop_entry(&entry, 1);
+        return;
+    }
+
+    if (undo_count >= undo_capacity) {
+        undo_capacity = undo_capacity ? undo_capacity * 2 : 16;
+        undo_log = (UndoEntry*)realloc(undo_log, undo_capacity * sizeof(UndoEntry));
+        if (!undo_log) {
+            printf("Memory reallocation failed!!\n");
+            exit(1);
+        }
+    }
+    undo_log[undo_count++] = entry;
+    undo_position = undo_count;
+    undo_trim();
+}
+
+// Let go of an entry. applied = its change is in the table (undo side),
+// 0 = it was undone (redo side). Rows it kept dead become normal tombstones.
+void undo_drop_entry(UndoEntry *entry, int applied) {
+    if ((entry->kind == UNDO_DELETE && applied) || (entry->kind == UNDO_ADD && !applied)) {
+        for (int i = 0; i < entry->row_count; i++) {
+            if (entry->rows[i] >= 0) set_review_pinned(entry->rows[i], 0);
+        }
+    }
+    if (entry->kind == UNDO_UPDATE) release_review(entry->swap);
+    undo_bytes -= entry->bytes;
+    free(entry->rows);
+    entry->rows = NULL;
+}
+
+// Drop the oldest entries until the journal fits the memory cap
+void undo_trim() {
+    int drop = 0;
+    while (undo_bytes > undo_byte_limit && drop < undo_count - 1) {
+        undo_drop_entry(&undo_log[drop], drop < undo_position);
+        drop++;
+    }
+    if (drop == 0) return;
+
+    memmove(undo_log, undo_log + drop, (undo_count - drop) * sizeof(UndoEntry));
+    undo_count -= drop;
+    undo_position = undo_position > drop ? undo_position - drop : 0;
+}
+
+// Renumber the journal's rows after a compaction. Every row it holds is live
+// or pinned, so none of them goes away.
+void undo_remap_rows(const int *new_row) {
+    for (int e = 0; e < undo_count; e++) {
+        UndoEntry *entry = &undo_log[e];
+        for (int i = 0; i < entry->row_count; i++) {
+            if (entry->rows[i] >= 0) entry->rows[i] = new_row[entry->rows[i]];
+        }
+    }
+}
+
+// Forget everything (the strings go with the pool)
+void undo_clear() {
+    for (int e = 0; e < undo_count; e++) {
+        free(undo_log[e].rows);
+    }
+    free(undo_log);
+    undo_log = NULL;
+    undo_count = undo_capacity = undo_position = 0;
+    undo_bytes = 0;
+}
+
+// Rough memory a dead row keeps alive: its strings and its slot in the columns
+size_t review_bytes(int row) {
+    return strlen(review_names[row]) + strlen(review_dates[row]) + strlen(review_feedbacks[row]) + 3 +
+           3 * sizeof(char*) + sizeof(uint8_t) + sizeof(int32_t);
+}
+
+// Undo (forward = 0) or redo (forward = 1) one entry, O(rows) either way:
+// deletes and adds only flip tombstones, updates swap the field values
+void undo_apply(UndoEntry *entry, int forward) {
+    int remove = (entry->kind == UNDO_DELETE) == forward;
+    for (int i = 0; i < entry->row_count; i++) {
+        int row = entry->rows[i];
+        if (row < 0) continue;
+
+        if (entry->kind == UNDO_UPDATE) {
+            Review *swap = &entry->swap;
+            if (swap->reviewer_name) swap->reviewer_name = set_review_name(row, swap->reviewer_name);
+            if (swap->satisfaction_score >= 0) swap->satisfaction_score = set_review_score(row, swap->satisfaction_score);
+            if (swap->review_date) swap->review_date = set_review_date(row, swap->review_date);
+            if (swap->feedback) swap->feedback = set_review_feedback(row, swap->feedback);
+            wal_log_update(row);
+        } else if (remove) {
+            kill_review_row(row);
+            set_review_pinned(row, 1);
+        } else {
+            revive_review_row(row);
+        }
+    }
+
+    if (entry->kind != UNDO_UPDATE) {
+        if (remove) {
+            wal_log_delete(entry->rows, entry->row_count);
+        } else {
+            wal_log_revive(entry->rows, entry->row_count);
+        }
+    }
+}
+
+void undo_last_change() {
+    if (undo_position == 0) {
+        printf("❌ Nothing to undo.\n");
+        return;
+    }
+
+    UndoEntry *entry = &undo_log[--undo_position];
+    int row = entry->rows[0];
+    switch (entry->kind) {
+        case UNDO_DELETE:
+            if (entry->row_count == 1) {
+                printf("\n♻️  Restoring deleted review:\n");
+                printf("  Name: %s\n", review_names[row]);
+                printf("  Score: %d/5\n", review_scores[row]);
+                printf("  Date: %s\n", review_dates[row]);
+                undo_apply(entry, 0);
+                printf("✅ Review restored successfully!\n");
+            } else {
+                printf("\n♻️  Restoring %d deleted reviews by %s\n", entry->row_count, review_names[row]);
+                undo_apply(entry, 0);
+                printf("✅ %d reviews restored successfully!\n", entry->row_count);
+            }
+            break;
+        case UNDO_ADD:
+            if (entry->row_count > 1) {
+                printf("\n↩️  Removing the %d reviews just imported\n", entry->row_count);
+            } else {
+                printf("\n↩️  Removing the review just added by %s\n", review_names[row]);
+            }
+            undo_apply(entry, 0);
+            printf("✅ Add undone!\n");
+            break;
+        case UNDO_UPDATE:
+            undo_apply(entry, 0);
+            printf("\n↩️  Review by %s is back to how it was\n", review_names[row]);
+            printf("✅ Update undone!\n");
+            break;
+    }
+    printf("💡 Tip: Use menu option 10 to redo.\n");
+}
+
+void redo_last_change() {
+    if (undo_position == undo_count) {
+        printf("❌ Nothing to redo.\n");
+        return;
+    }
+
+    UndoEntry *entry = &undo_log[undo_position++];
+    int row = entry->rows[0];
+    switch (entry->kind) {
+        case UNDO_DELETE:
+            printf("\n🔁 Deleting %d review(s) by %s again\n", entry->row_count, review_names[row]);
+            break;
+        case UNDO_ADD:
+            if (entry->row_count > 1) {
+                printf("\n🔁 Importing the %d reviews again\n", entry->row_count);
+            } else {
+                printf("\n🔁 Adding the review by %s again\n", review_names[row]);
+            }
+            break;
+        case UNDO_UPDATE:
+            printf("\n🔁 Updating the review by %s again\n", review_names[row]);
+            break;
+    }
+    undo_apply(entry, 1);
+    printf("✅ Redone!\n");
+}
+
+// statics and display
+
+void show_statistics() {
+    if (live_review_count() == 0) {
+        printf("\n📊 No data to show statistics.\n");
+        return;
+    }
+    
+    printf("\n╔════════════════════════════════════════╗\n");
+    printf("║           📊 Statistics                ║\n");
+    printf("╚════════════════════════════════════════╝\n");
+    
+    ScoreStats stats;
+    compute_live_score_stats(&stats);
+    int live_count = live_review_count();
+    
+    printf("Total Reviews: %d\n", live_count);
+    printf("Average Score: %.2f/5\n", (double)stats.sum / live_count);
+    printf("Lowest/Highest: %d/%d\n", stats.min_score, stats.max_score);
+    if (stats.out_of_range > 0) {
+        printf("Out of range scores: %d\n", stats.out_of_range);
+    }
+    printf("\n");
+    
+    printf("Score Distribution:\n");
+    for (int i = 4; i >= 0; i--) {
+        printf("%d ⭐ ", i + 1);
+        int bars = (int)(((long long)stats.counts[i] * 20) / live_count);
+        for (int j = 0; j < bars; j++) printf("█");
+        printf(" (%d)\n", stats.counts[i]);
+    }
+}
+
+/**
+ * One pass over the score column: per-score counts, sums, min/max and the
+ * number of scores outside 1-5. show_statistics and display_all_reviews both
+ * read from this instead of looping themselves.
+ * Picks AVX2 or SSE2 at runtime when the CPU has it, otherwise plain C.
+ */
+void compute_score_stats(const uint8_t *scores, int count, ScoreStats *stats) {
+    memset(stats, 0, sizeof(ScoreStats));
+    if (count <= 0) return;
+    stats->min_score = 255;
+
+#if SCORE_STATS_X86
+    if (__builtin_cpu_supports("avx2")) {
+        score_stats_avx2(scores, count, stats);
+        return;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        score_stats_sse2(scores, count, stats);
+        return;
+    }
+#endif
+    score_stats_scalar(scores, count, stats);
+}
+
+// compute_score_stats() over the live rows only. Runs of live rows go through
+// the kernel as they are, the tombstone bitmap is skipped a word at a time.
+void compute_live_score_stats(ScoreStats *stats) {
+    if (dead_count == 0) {
+        compute_score_stats(review_scores, review_count, stats);
+        return;
+    }
+
+    memset(stats, 0, sizeof(ScoreStats));
+    stats->min_score = 255;
+    int row = next_row_in_state(0, 0);
+    while (row < review_count) {
+        int end = next_row_in_state(row, 1);
+        ScoreStats part;
+        compute_score_stats(review_scores + row, end - row, &part);
+        merge_score_stats(stats, &part);
+        row = next_row_in_state(end, 0);
+    }
+    if (stats->min_score > stats->max_score) stats->min_score = 0;  // no live rows
+}
+
+// First row at or after 'from' that is dead (dead = 1) or live (dead = 0),
+// review_count if there is none
+int next_row_in_state(int from, int dead) {
+    while (from < review_count) {
+        uint64_t word = review_dead[from / 64];
+        if (!dead) word = ~word;
+        word &= ~0ULL << (from % 64);
+        if (word) {
+            int row = (from / 64) * 64 + __builtin_ctzll(word);
+            return row < review_count ? row : review_count;
+        }
+        from = (from / 64 + 1) * 64;
+    }
+    return review_count;
+}
+
+void merge_score_stats(ScoreStats *total, const ScoreStats *part) {
+    for (int i = 0; i < 5; i++) total->counts[i] += part->counts[i];
+    total->out_of_range += part->out_of_range;
+    total->sum += part->sum;
+    total->sum_all += part->sum_all;
+    if (part->min_score < total->min_score) total->min_score = part->min_score;
+    if (part->max_score > total->max_score) total->max_score = part->max_score;
+}
+
+// Plain C version, also finishes the tail the vector versions leave over
+void score_stats_scalar(const uint8_t *scores, int count, ScoreStats *stats) {
+    for (int i = 0; i < count; i++) {
+        int score = scores[i];
+        stats->sum_all += score;
+        if (score < stats->min_score) stats->min_score = score;
+        if (score > stats->max_score) stats->max_score = score;
+        if (score >= 1 && score <= 5) {
+            stats->counts[score - 1]++;
+            stats->sum += score;
+        } else {
+            stats->out_of_range++;
+        }
+    }
+}
+
+#if SCORE_STATS_X86
+/*
+ * Both vector versions work the same way: compare each block of scores
+ * against 1..5 and subtract the 0xFF masks from byte counters. A byte counter
+ * overflows after 255 blocks, so every 255 blocks they are folded into 64-bit
+ * totals with SAD (sum of absolute differences against zero).
+ */
+__attribute__((target("sse2")))
+void score_stats_sse2(const uint8_t *scores, int count, ScoreStats *stats) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i totals[5], sum_all = zero;
+    __m128i min_vec = _mm_set1_epi8((char)0xFF), max_vec = zero;
+    for (int v = 0; v < 5; v++) totals[v] = zero;
+
+    int i = 0;
+    while (i + 16 <= count) {
+        __m128i counters[5];
+        for (int v = 0; v < 5; v++) counters[v] = zero;
+
+        int blocks = 0;
+        for (; blocks < 255 && i + 16 <= count; blocks++, i += 16) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(scores + i));
+            for (int v = 0; v < 5; v++) {
+                counters[v] = _mm_sub_epi8(counters[v], _mm_cmpeq_epi8(x, _mm_set1_epi8((char)(v + 1))));
+            }
+            sum_all = _mm_add_epi64(sum_all, _mm_sad_epu8(x, zero));
+            min_vec = _mm_min_epu8(min_vec, x);
+            max_vec = _mm_max_epu8(max_vec, x);
+        }
+        for (int v = 0; v < 5; v++) {
+            totals[v] = _mm_add_epi64(totals[v], _mm_sad_epu8(counters[v], zero));
+        }
+    }
+
+    uint64_t lanes[2];
+    for (int v = 0; v < 5; v++) {
+        _mm_storeu_si128((__m128i*)lanes, totals[v]);
+        stats->counts[v] += (int)(lanes[0] + lanes[1]);
+    }
+    _mm_storeu_si128((__m128i*)lanes, sum_all);
+    stats->sum_all += lanes[0] + lanes[1];
+
+    uint8_t bytes[16];
+    _mm_storeu_si128((__m128i*)bytes, min_vec);
+    for (int b = 0; b < 16; b++) if (bytes[b] < stats->min_score) stats->min_score = bytes[b];
+    _mm_storeu_si128((__m128i*)bytes, max_vec);
+    for (int b = 0; b < 16; b++) if (bytes[b] > stats->max_score) stats->max_score = bytes[b];
+
+    int in_range = 0;
+    for (int v = 0; v < 5; v++) {
+        in_range += stats->counts[v];
+        stats->sum += (long long)stats->counts[v] * (v + 1);
+    }
+    stats->out_of_range = i - in_range;
+
+    score_stats_scalar(scores + i, count - i, stats);
+}
+
+__attribute__((target("avx2")))
+void score_stats_avx2(const uint8_t *scores, int count, ScoreStats *stats) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i totals[5], sum_all = zero;
+    __m256i min_vec = _mm256_set1_epi8((char)0xFF), max_vec = zero;
+    for (int v = 0; v < 5; v++) totals[v] = zero;
+
+    int i = 0;
+    while (i + 32 <= count) {
+        __m256i counters[5];
+        for (int v = 0; v < 5; v++) counters[v] = zero;
+
+        int blocks = 0;
+        for (; blocks < 255 && i + 32 <= count; blocks++, i += 32) {
+            __m256i x = _mm256_loadu_si256((const __m256i*)(scores + i));
+            for (int v = 0; v < 5; v++) {
+                counters[v] = _mm256_sub_epi8(counters[v], _mm256_cmpeq_epi8(x, _mm256_set1_epi8((char)(v + 1))));
+            }
+            sum_all = _mm256_add_epi64(sum_all, _mm256_sad_epu8(x, zero));
+            min_vec = _mm256_min_epu8(min_vec, x);
+            max_vec = _mm256_max_epu8(max_vec, x);
+        }
+        for (int v = 0; v < 5; v++) {
+            totals[v] = _mm256_add_epi64(totals[v], _mm256_sad_epu8(counters[v], zero));
+        }
+    }
+
+    uint64_t lanes[4];
+    for (int v = 0; v < 5; v++) {
+        _mm256_storeu_si256((__m256i*)lanes, totals[v]);
+        stats->counts[v] += (int)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+    }
+    _mm256_storeu_si256((__m256i*)lanes, sum_all);
+    stats->sum_all += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+    uint8_t bytes[32];
+    _mm256_storeu_si256((__m256i*)bytes, min_vec);
+    for (int b = 0; b < 32; b++) if (bytes[b] < stats->min_score) stats->min_score = bytes[b];
+    _mm256_storeu_si256((__m256i*)bytes, max_vec);
+    for (int b = 0; b < 32; b++) if (bytes[b] > stats->max_score) stats->max_score = bytes[b];
+
+    int in_range = 0;
+    for (int v = 0; v < 5; v++) {
+        in_range += stats->counts[v];
+        stats->sum += (long long)stats->counts[v] * (v + 1);
+    }
+    stats->out_of_range = i - in_range;
+
+    score_stats_scalar(scores + i, count - i, stats);
+}
+#endif
+
+void display_search_results(int *found_indices, int count, const char *search_term);
+void display_numbered_results(int *indices, int count);
+
+// helper functions
+
+char* allocate_string(const char *str) {
+    if (!str) return NULL; // check if it's an empty pointer
+
+    size_t size = strlen(str) + 1;
+    char *new_str = pool_alloc(size);
+    memcpy(new_str, str, size); // not just copies the pointer, but the actual characters
+    return new_str;
+}
+
+// Pool copy of str, case-folded (index keys)
+char* allocate_folded(const char *str) {
+    size_t size = strlen(str) + 1;
+    char *folded = pool_alloc(size);
+    fold_case(folded, str, size);
+    return folded;
+}
+
+// Simple case folding for the scripts we see in names, sorted by first.
+// A code point folds to cp + delta when it is in [first, last] and, for
+// stride 2 (alternating upper/lower pairs), an even distance from first.
+// Every mapping keeps the UTF-8 length, so folding never resizes a string.
+// Thai and other caseless scripts are copied through unchanged.
+const CaseFoldRange case_fold_ranges[] = {
+    {0x00C0, 0x00D6, 32, 1},    // Latin-1: À..Ö
+    {0x00D8, 0x00DE, 32, 1},    // Ø..Þ
+    {0x0100, 0x012F, 1, 2},     // Latin Extended-A pairs
+    {0x0132, 0x0137, 1, 2},
+    {0x0139, 0x0148, 1, 2},
+    {0x014A, 0x0177, 1, 2},
+    {0x0178, 0x0178, -121, 1},  // Ÿ -> ÿ
+    {0x0179, 0x017E, 1, 2},
+    {0x0391, 0x03A1, 32, 1},    // Greek capitals
+    {0x03A3, 0x03AB, 32, 1},
+    {0x0400, 0x040F, 80, 1},    // Cyrillic Ѐ..Џ
+    {0x0410, 0x042F, 32, 1},    // Cyrillic А..Я
+    {0x0460, 0x0481, 1, 2},
+    {0x048A, 0x04BF, 1, 2},
+    {0x1E00, 0x1E95, 1, 2},     // Latin Extended Additional (Vietnamese)
+    {0x1EA0, 0x1EFF, 1, 2},
+    {0xFF21, 0xFF3A, 32, 1},    // fullwidth Ａ..Ｚ
+};
+
+uint32_t fold_code_point(uint32_t cp) {
+    int count = sizeof(case_fold_ranges) / sizeof(case_fold_ranges[0]);
+    for (int i = 0; i < count && cp >= case_fold_ranges[i].first; i++) {
+        const CaseFoldRange *range = &case_fold_ranges[i];
+        if (cp <= range->last && (cp - range->first) % range->stride == 0) {
+            return cp + range->delta;
+        }
+    }
+    return cp;
+}
+
+// Case-fold src into dst (same length, dst may be src). ASCII goes 16 bytes
+// at a time where SSE2 is there, multi-byte UTF-8 through the table above.
+// Malformed UTF-8 bytes are copied as they are.
+void fold_case(char *dst, const char *src, size_t length) {
+    const unsigned char *in = (const unsigned char*)src;
+    unsigned char *out = (unsigned char*)dst;
+    size_t i = 0;
+
+    while (i < length) {
+#ifdef __SSE2__
+        if (i + 16 <= length) {
+            __m128i chunk = _mm_loadu_si128((const __m128i*)(in + i));
+            if (_mm_movemask_epi8(chunk) == 0) {
+                // All ASCII: add 0x20 to the bytes in 'A'..'Z'
+                __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(chunk, _mm_set1_epi8('A' - 1)),
+                                              _mm_cmplt_epi8(chunk, _mm_set1_epi8('Z' + 1)));
+                chunk = _mm_or_si128(chunk, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+                _mm_storeu_si128((__m128i*)(out + i), chunk);
+                i += 16;
+                continue;
+            }
+        }
+#endif
+        unsigned char c = in[i];
+        if (c < 0x80) {
+            out[i] = (c >= 'A' && c <= 'Z') ? c + 0x20 : c;
+            i++;
+            continue;
+        }
+
+        // Lead byte gives the sequence length, only 2 and 3 byte forms have folds
+        int seq = (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : 1;
+        int valid = seq > 1 && i + seq <= length;
+        for (int k = 1; valid && k < seq; k++) {
+            if ((in[i + k] & 0xC0) != 0x80) valid = 0;
+        }
+        if (!valid) {
+            out[i] = c;
+            i++;
+            continue;
+        }
+
+        uint32_t cp;
+        if (seq == 2) {
+            cp = fold_code_point(((c & 0x1Fu) << 6) | (in[i + 1] & 0x3Fu));
+            out[i] = 0xC0 | (cp >> 6);
+            out[i + 1] = 0x80 | (cp & 0x3F);
+        } else {
+            cp = fold_code_point(((c & 0x0Fu) << 12) | ((in[i + 1] & 0x3Fu) << 6) | (in[i + 2] & 0x3Fu));
+            out[i] = 0xE0 | (cp >> 12);
+            out[i + 1] = 0x80 | ((cp >> 6) & 0x3F);
+            out[i + 2] = 0x80 | (cp & 0x3F);
+        }
+        i += seq;
+    }
+}
+
+// Give a review string back to the pool (strings in the mmapped CSV are left alone)
+void release_string(char *str) {
+    if (!str || is_mapped_string(str)) return;
+
+    // The size class comes from the length, strings are never edited in place
+    size_t class_index = (strlen(str) + 1 + POOL_CLASS_SIZE - 1) / POOL_CLASS_SIZE - 1;
+    if (class_index >= POOL_CLASS_COUNT) return; // long strings wait for pool_free_all()
+
+    *(char**)str = pool_free_lists[class_index];
+    pool_free_lists[class_index] = str;
+}
+
+char* pool_alloc(size_t size) {
+    size_t class_index = (size + POOL_CLASS_SIZE - 1) / POOL_CLASS_SIZE - 1;
+    size_t rounded = (class_index + 1) * POOL_CLASS_SIZE;
+
+    // Reuse a released block of the same class first
+    if (class_index < POOL_CLASS_COUNT && pool_free_lists[class_index]) {
+        char *block = pool_free_lists[class_index];
+        pool_free_lists[class_index] = *(char**)block;
+        return block;
+    }
+
+    if (!pool_slabs || pool_slabs->used + rounded > pool_slabs->size) {
+        size_t slab_size = rounded > POOL_SLAB_SIZE ? rounded : POOL_SLAB_SIZE;
+        PoolSlab *slab = malloc(sizeof(PoolSlab) + slab_size);
+        if (!slab) {
+            printf("Memory allocation failed for string\n");
+            exit(1); // netter to terminate cleanly than crash mysteriously
+        }
+        slab->size = slab_size;
+        slab->used = 0;
+
+        // Huge strings get a slab of their own, keep bumping from the current one
+        if (rounded > POOL_SLAB_SIZE && pool_slabs) {
+            slab->used = rounded;
+            slab->next = pool_slabs->next;
+            pool_slabs->next = slab;
+            return slab->data;
+        }
+        slab->next = pool_slabs;
+        pool_slabs = slab;
+    }
+
+    char *block = pool_slabs->data + pool_slabs->used;
+    pool_slabs->used += rounded;
+    return block;
+}
+
+void pool_free_all() {
+    while (pool_slabs) {
+        PoolSlab *next = pool_slabs->next;
+        free(pool_slabs);
+        pool_slabs = next;
+    }
+    memset(pool_free_lists, 0, sizeof(pool_free_lists));
+}
+
+int is_mapped_string(const char *str) {
+    return mapped_csv && str >= mapped_csv && str < mapped_csv + mapped_csv_size;
+}
+
+// Room for at least one more row: the next block (heap columns double).
+// Quiet, reserve_reviews() only speaks up when it fails.
+void resize_review_array() {
+    reserve_reviews(review_store ? capacity + 1 : capacity * 2);
+}
+
+// Grow every column to hold at least rows reviews, in one step
+void reserve_reviews(int rows) {
+    if (rows <= capacity) return;
+    if (review_store) {
+        // Whole blocks, opened up where they are; fresh pages read as zero
+        // so the bitmaps start out clear
+        if (rows > REVIEW_MAX_ROWS) {
+            printf("Memory reallocation failed!!\n");
+            exit(1);
+        }
+        rows = (rows + REVIEW_BLOCK_ROWS - 1) / REVIEW_BLOCK_ROWS * REVIEW_BLOCK_ROWS;
+        commit_column(review_names, sizeof(char*), capacity, rows);
+        commit_column(review_scores, sizeof(uint8_t), capacity, rows);
+        commit_column(review_date_keys, sizeof(int32_t), capacity, rows);
+        commit_column(review_dates, sizeof(char*), capacity, rows);
+        commit_column(review_feedbacks, sizeof(char*), capacity, rows);
+        commit_column(review_dead, 0, capacity, rows);
+        commit_column(review_pinned, 0, capacity, rows);
+        commit_column(review_changed, 0, capacity, rows);
+        commit_column(review_ids, sizeof(int32_t), capacity, rows);
+        capacity = rows;
+        return;
+    }
+    int old_words = (capacity + 63) / 64;
+    capacity = rows;
+    review_names = (char**)realloc(review_names, capacity * sizeof(char*));
+    review_scores = (uint8_t*)realloc(review_scores, capacity * sizeof(uint8_t));
+    review_date_keys = (int32_t*)realloc(review_date_keys, capacity * sizeof(int32_t));
+    review_dates = (char**)realloc(review_dates, capacity * sizeof(char*));
+    review_feedbacks = (char**)realloc(review_feedbacks, capacity * sizeof(char*));
+    int words = (capacity + 63) / 64;
+    review_dead = (uint64_t*)realloc(review_dead, words * sizeof(uint64_t));
+    review_pinned = (uint64_t*)realloc(review_pinned, words * sizeof(uint64_t));
+    review_changed = (uint64_t*)realloc(review_changed, words * sizeof(uint64_t));
+    review_ids = (int32_t*)realloc(review_ids, capacity * sizeof(int32_t));
+    if (!review_names || !review_scores || !review_date_keys || !review_dates || !review_feedbacks || !review_dead || !review_pinned || !review_changed || !review_ids) {
+        printf("Memory reallocation failed!!\n");
+        exit(1);
+    }
+    memset(review_dead + old_words, 0, (words - old_words) * sizeof(uint64_t));
+    memset(review_pinned + old_words, 0, (words - old_words) * sizeof(uint64_t));
+    memset(review_changed + old_words, 0, (words - old_words) * sizeof(uint64_t));
+}
+
+// Reserve the address range of every column (see review_store) and point
+// the columns into it. Returns 0 if the range cannot be had.
+int map_review_store() {
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t pointer_span = (column_bytes(REVIEW_MAX_ROWS, sizeof(char*)) + page - 1) / page * page;
+    size_t score_span = (column_bytes(REVIEW_MAX_ROWS, sizeof(uint8_t)) + page - 1) / page * page;
+    size_t int_span = (column_bytes(REVIEW_MAX_ROWS, sizeof(int32_t)) + page - 1) / page * page;
+    size_t bit_span = (column_bytes(REVIEW_MAX_ROWS, 0) + page - 1) / page * page;
+    size_t size = 3 * pointer_span + score_span + 2 * int_span + 3 * bit_span;
+    char *store = mmap(NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (store == MAP_FAILED) {
+        return 0;
+    }
+    review_store = store;
+    review_store_size = size;
+
+    review_names = (char**)store;
+    review_dates = (char**)(store += pointer_span);
+    review_feedbacks = (char**)(store += pointer_span);
+    review_scores = (uint8_t*)(store += pointer_span);
+    review_date_keys = (int32_t*)(store += score_span);
+    review_ids = (int32_t*)(store += int_span);
+    review_dead = (uint64_t*)(store += int_span);
+    review_pinned = (uint64_t*)(store += bit_span);
+    review_changed = (uint64_t*)(store += bit_span);
+    return 1;
+}
+
+// Bytes a column of rows rows takes, width bytes per row (0 = one bit)
+size_t column_bytes(size_t rows, size_t width) {
+    return width ? rows * width : (rows + 63) / 64 * sizeof(uint64_t);
+}
+
+// Open up rows [old_rows, rows) of a column in review_store for writing
+void commit_column(void *column, size_t width, int old_rows, int rows) {
+    size_t page = sysconf(_SC_PAGESIZE);
+    uintptr_t from = ((uintptr_t)column + column_bytes(old_rows, width)) / page * page;
+    uintptr_t to = ((uintptr_t)column + column_bytes(rows, width) + page - 1) / page * page;
+    if (to > from && mprotect((void*)from, to - from, PROT_READ | PROT_WRITE) != 0) {
+        printf("Memory reallocation failed!!\n");
+        exit(1);
+    }
+}
+
+char* toLowerCase(const char *str) {
+    if (!str) return NULL;
+
+    size_t size = strlen(str) + 1;
+    char* lower = malloc(size);
+    if (!lower) return NULL; // only check malloc result
+
+    fold_case(lower, str, size);
+    return lower;
+}
+
+void trim_whitespace(char *str) {
+    if (!str) return;
+    
+    // Trim leading spaces
+    char *start = str;
+    while (*start && isspace(*start)) start++;
+    
+    // Trim trailing spaces
+    char *end = start + strlen(start) - 1;
+    while (end > start && isspace(*end)) end--;
+    
+    // Copy trimmed string
+    size_t len = end - start + 1;
+    memmove(str, start, len);
+    str[len] = '\0';
+}
+
+// First row (lowest index) by exactly this name, -1 if there is none
+int find_review_by_name(const char *name) {
+    int count;
+    const int *rows = find_rows_by_name(name, &count);
+
+    int first = -1;
+    for (int i = 0; i < count; i++) {
+        if (!is_review_live(rows[i])) continue;
+        if (first < 0 || rows[i] < first) first = rows[i];
+    }
+    return first;
+}
+
+// validation
+
+int is_valid_date(const char *date_str) {
+    if (!date_str || strlen(date_str) != 10) return 0;
+    if (date_str[4] != '-' || date_str[7] != '-') return 0;
+    
+    for (int i = 0; i < 10; i++) {
+        if (i == 4 || i == 7) continue;
+        if (date_str[i] < '0' || date_str[i] > '9') return 0;
+    }
+    
+    int year = (date_str[0]-'0')*1000 + (date_str[1]-'0')*100 + 
+               (date_str[2]-'0')*10 + (date_str[3]-'0');
+    int month = (date_str[5]-'0')*10 + (date_str[6]-'0');
+    int day = (date_str[8]-'0')*10 + (date_str[9]-'0');
+    
+    // Check year is in valid range (BE or CE) - DON'T RETURN YET
+    int valid_year = 0;
+    if (year >= 2400 && year <= 2700) {
+        valid_year = 1; // BE year
+    } else if (year >= 1900 && year <= 2100) {
+        valid_year = 1; // CE year
+    }
+    
+    if (!valid_year) return 0;  // Invalid year range
+    
+    // NOW check month and day (this code will actually run now!)
+    if (month < 1 || month > 12) return 0;
+    if (day < 1 || day > 31) return 0;
+    
+    int days_in_month[] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (day > days_in_month[month - 1]) return 0;
+    
+    return 1;  // All checks passed
+}
+
+int parseScore(const char* score_str) {
+    if (!score_str || strlen(score_str) == 0) {
+        return -1;
+    }
+
+    char *endptr;
+    long score_long = strtol(score_str, &endptr, 10);
+
+    if (*endptr != '\0' || score_long < 1 || score_long > 5) {
+        return -1;
+    }
+
+    return (int)score_long;
+}
+
+// Why fields (name, score, date, feedback) can't be a review, NULL if they
+// can: the checks of the Add Review menu. *score gets the parsed score.
+const char* review_fields_error(char **fields, int *score) {
+    size_t name_length = strlen(fields[0]);
+    *score = parseScore(fields[1]);
+    if (name_length == 0 || name_length > 50) return "name must be 1-50 characters";
+    if (*score < 0) return "score must be 1-5";
+    if (!is_valid_date(fields[2])) return "date must be YYYY-MM-DD";
+    if (strlen(fields[3]) > 200) return "feedback longer than 200 characters";
+    return NULL;
+}
+
+// typo matching
+
+int min3(int a, int b, int c) {
+    int min = a;
+    if (b < min) min = b;
+    if (c < min) min = c;
+    return min;
+}
+
+/**
+ * Calculate Levenshtein Distance (Edit Distance) using "Levenshtein distance algorithm"
+ * Returns number of edits needed to transform str1 to str2
+ * editDistance("kitten", "sitting") = 3
+ *   editDistance("john", "jhon") = 2
+ *   editDistance("sarah", "sara") = 1
+ * Same as editDistanceWithin() with no cutoff
+ */
+
+int editDistance(const char* str1, const char* str2) {
+    if (!str1 || !str2) return 999;
+    return editDistanceWithin(str1, str2, (int)(strlen(str1) + strlen(str2)));
+}
+
+/**
+ * Bit-parallel edit distance (Myers 1999, multi-word blocks as in Hyyro 2003)
+ * Each text character updates a whole 64-row column of the DP table with a
+ * handful of word operations, instead of one cell at a time.
+ * Stops early and returns maxDistance + 1 once the answer must be bigger than
+ * maxDistance. No allocation per call: the scratch below is reused.
+ */
+int editDistanceWithin(const char* str1, const char* str2, int maxDistance) {
+    if (!str1 || !str2) return 999;
+
+    // The shorter string is the pattern (fewer 64-row blocks), distance is symmetric
+    const char *pattern = str1, *text = str2;
+    int m = strlen(str1);
+    int n = strlen(str2);
+    if (m > n) {
+        pattern = str2;
+        text = str1;
+        int temp = m;
+        m = n;
+        n = temp;
+    }
+
+    if (n - m > maxDistance) return maxDistance + 1;  // need at least n-m inserts
+    if (m == 0) return n;
+
+    int blocks = (m + 63) / 64;
+    if (blocks > myers_capacity && !myers_grow_scratch(blocks)) {
+        printf("Memory allocation failed in editDistance!\n");
+        return 999;
+    }
+
+    // Match masks: bit i of peq[c] is set when pattern[i] == c (case-insensitive)
+    for (int i = 0; i < m; i++) {
+        unsigned char c = tolower((unsigned char)pattern[i]);
+        myers_peq[c * blocks + i / 64] |= 1ULL << (i % 64);
+    }
+    for (int b = 0; b < blocks; b++) {
+        myers_pv[b] = ~0ULL;
+        myers_mv[b] = 0;
+    }
+
+    uint64_t last_row_bit = 1ULL << ((m - 1) % 64);
+    int score = m;  // distance from the whole pattern to an empty text
+
+    for (int j = 0; j < n; j++) {
+        const uint64_t *eq = myers_peq + tolower((unsigned char)text[j]) * blocks;
+
+        // Top row is 0,1,2,... so every column starts with a +1 carry
+        int carry = 1;
+        for (int b = 0; b < blocks; b++) {
+            uint64_t high_bit = (b == blocks - 1) ? last_row_bit : (1ULL << 63);
+            carry = myers_block(&myers_pv[b], &myers_mv[b], eq[b], carry, high_bit);
+        }
+        score += carry;
+
+        // The last row drops by at most 1 per remaining column
+        if (score - (n - j - 1) > maxDistance) {
+            score = maxDistance + 1;
+            break;
+        }
+    }
+
+    // Leave the match masks zeroed for the next call
+    for (int i = 0; i < m; i++) {
+        unsigned char c = tolower((unsigned char)pattern[i]);
+        myers_peq[c * blocks + i / 64] = 0;
+    }
+
+    return score;
+}
+
+/**
+ * Fewest edits that turn pattern into some substring of text, or
+ * maxDistance + 1 when that is more. Skipping text before and after the
+ * match is free and swapping two neighbouring letters counts as one edit,
+ * so partialDistanceWithin("jhon", "John Smith", 1) = 1.
+ * Rows are kept for the pattern, text is walked left to right: O(m*n) time.
+ */
+int partialDistanceWithin(const char* pattern, const char* text, int maxDistance) {
+    if (!pattern || !text) return 999;
+
+    int m = strlen(pattern);
+    int n = strlen(text);
+    if (m == 0) return 0;
+
+    if (m + 1 > partial_capacity) {
+        int *rows = realloc(partial_rows, 3 * (m + 1) * sizeof(int));
+        if (!rows) {
+            printf("Memory allocation failed in editDistance!\n");
+            return 999;
+        }
+        partial_rows = rows;
+        partial_capacity = m + 1;
+    }
+    // Column j of the table, j-1 and j-2 (for transpositions)
+    int *before = partial_rows;
+    int *prev = partial_rows + (m + 1);
+    int *curr = partial_rows + 2 * (m + 1);
+
+    for (int i = 0; i <= m; i++) prev[i] = i;
+    int best = prev[m];
+
+    for (int j = 1; j <= n && best > 0; j++) {
+        char tc = tolower((unsigned char)text[j - 1]);
+        curr[0] = 0;  // a match may start at any column
+        for (int i = 1; i <= m; i++) {
+            char pc = tolower((unsigned char)pattern[i - 1]);
+            int cost = (pc == tc) ? 0 : 1;
+            curr[i] = min3(prev[i] + 1, curr[i - 1] + 1, prev[i - 1] + cost);
+            if (i > 1 && j > 1 && pc == tolower((unsigned char)text[j - 2])
+                && tolower((unsigned char)pattern[i - 2]) == tc
+                && before[i - 2] + 1 < curr[i]) {
+                curr[i] = before[i - 2] + 1;
+            }
+        }
+        if (curr[m] < best) best = curr[m];
+
+        int *spare = before;
+        before = prev;
+        prev = curr;
+        curr = spare;
+    }
+
+    return best <= maxDistance ? best : maxDistance + 1;
+}
+
+// Advance one 64-row block by one text character
+// carry_in/return value = change of the DP value across the block's top/bottom row
+int myers_block(uint64_t *pv, uint64_t *mv, uint64_t eq, int carry_in, uint64_t high_bit) {
+    uint64_t Pv = *pv;
+    uint64_t Mv = *mv;
+    uint64_t Xv = eq | Mv;
+    if (carry_in < 0) eq |= 1;
+    uint64_t Xh = (((eq & Pv) + Pv) ^ Pv) | eq;
+    uint64_t Ph = Mv | ~(Xh | Pv);
+    uint64_t Mh = Pv & Xh;
+
+    int carry_out = 0;
+    if (Ph & high_bit) carry_out = 1;
+    else if (Mh & high_bit) carry_out = -1;
+
+    Ph <<= 1;
+    Mh <<= 1;
+    if (carry_in < 0) Mh |= 1;
+    else if (carry_in > 0) Ph |= 1;
+
+    *pv = Mh | ~(Xv | Ph);
+    *mv = Ph & Xv;
+    return carry_out;
+}
+
+int myers_grow_scratch(int blocks) {
+    myers_free_scratch();
+    myers_peq = calloc((size_t)256 * blocks, sizeof(uint64_t));
+    myers_pv = malloc(blocks * sizeof(uint64_t));
+    myers_mv = malloc(blocks * sizeof(uint64_t));
+    if (!myers_peq || !myers_pv || !myers_mv) {
+        myers_free_scratch();
+        return 0;
+    }
+    myers_capacity = blocks;
+    return 1;
+}
+
+void myers_free_scratch() {
+    free(myers_peq);
+    free(myers_pv);
+    free(myers_mv);
+    myers_peq = myers_pv = myers_mv = NULL;
+    myers_capacity = 0;
+    free(partial_rows);
+    partial_rows = NULL;
+    partial_capacity = 0;
+}
+
+// backup/restore
+// A backup is a small manifest listing chunks of the CSV text. Chunks end
+// after rows whose text hashes to a pattern, so an edit only changes the
+// chunks around it. Chunks are named by their content and kept once in
+// BACKUP_CHUNK_DIR, compressed as they are cut: a backup only writes chunks
+// the store does not have yet, and restore unpacks them one at a time
+// straight into the table.
+// The chunks of the last backup are remembered with the rows they hold, and
+// rows changed since are marked (mark_row_changed), so the rows of an
+// untouched chunk are not even read again.
+
+// The manifest's name also goes to manifest (may be NULL)
+int backup_reviews(const char *backup_name, char *manifest, size_t manifest_size) {
+    char filename[256];
+    time_t now = time(NULL);
+    struct tm *t = localtime(&now);
+
+    if (backup_name) {
+        snprintf(filename, sizeof(filename), "backup_%s.manifest", backup_name);
+    } else {
+        snprintf(filename, sizeof(filename),
+                 "backup_%04d%02d%02d_%02d%02d%02d.manifest",
+                 t->tm_year + 1900, t->tm_mon + 1, t->tm_mday,
+                 t->tm_hour, t->tm_min, t->tm_sec);
+    }
+
+    if (mkdir(BACKUP_CHUNK_DIR, 0755) != 0 && errno != EEXIST) {
+        printf("❌ Cannot create %s!\n", BACKUP_CHUNK_DIR);
+        return -1;
+    }
+
+    char temp_filename[300];
+    snprintf(temp_filename, sizeof(temp_filename), "%s.tmp", filename);
+    BackupWriter writer;
+    memset(&writer, 0, sizeof(writer));
+    writer.manifest = fopen(temp_filename, "w");
+    if (!writer.manifest) {
+        printf("Cannot create/open file for writing!\n");
+        return -1;
+    }
+    writer.ok = fprintf(writer.manifest, "%s\n", BACKUP_MAGIC) > 0;
+
+    // Walk the rows a chunk at a time, the old chunk is kept whenever one
+    // starts at the same row and none of its rows changed
+    int row = 0, old = 0;
+    do {
+        while (old < backup_chunk_count && backup_chunks[old].first_row < row) old++;
+        int end = old + 1 < backup_chunk_count ? backup_chunks[old + 1].first_row : backup_rows;
+        if (old < backup_chunk_count && backup_chunks[old].first_row == row && end > row &&
+            !backup_chunks[old].changed && !any_row_changed(row, end) && backup_keep_chunk(&writer, &backup_chunks[old])) {
+            row = end;
+        } else {
+            row = backup_cut_chunk(&writer, row);
+        }
+    } while (writer.ok && row < review_count);
+    free(writer.text);
+    free(writer.packed);
+
+    // The names of the new chunks must be on disk before a manifest lists them
+    if (writer.new_chunks > 0 && fsync_parent_dir(BACKUP_CHUNK_DIR "/") != 0) writer.ok = 0;
+    if (fflush(writer.manifest) != 0 || fsync(fileno(writer.manifest)) != 0) writer.ok = 0;
+    if (fclose(writer.manifest) != 0 || !writer.ok || rename(temp_filename, filename) != 0) {
+        printf("Cannot create/open file for writing!\n");
+        remove(temp_filename);
+        free(writer.chunks);
+        return -1;
+    }
+    fsync_parent_dir(filename);
+
+    // What was just written is the base for the next backup
+    free(backup_chunks);
+    backup_chunks = writer.chunks;
+    backup_chunk_count = writer.chunk_count;
+    backup_chunk_capacity = writer.chunk_capacity;
+    backup_rows = review_count;
+    memset(review_changed, 0, (review_count + 63) / 64 * sizeof(uint64_t));
+
+    if (manifest) snprintf(manifest, manifest_size, "%s", filename);
+    printf("✅ Backup created: %s\n", filename);
+    printf("   %d chunk(s), %d new (%zu bytes stored)\n", writer.chunk_count, writer.new_chunks, writer.new_bytes);
+    return 0;
+}
+
+// Write one chunk starting at row (the CSV header goes in front of row 0),
+// the same text save_reviews_to_csv() writes. Returns the row after it.
+int backup_cut_chunk(BackupWriter *writer, int row) {
+    writer->text_size = 0;
+    if (row == 0) {
+        backup_append(writer, "ReviewerName,SatisfactionScore,ReviewDate,Feedback\n", 51);
+    }
+    int first_row = row;
+    while (row < review_count) {
+        if (!is_review_live(row++)) continue;
+
+        size_t start = writer->text_size;
+        backup_reserve(writer, csv_row_bound(row - 1));
+        writer->text_size = csv_put_row(writer->text + start, row - 1) - writer->text;
+
+        uint32_t hash = crc32c(0, writer->text + start, writer->text_size - start);
+        if ((writer->text_size >= CHUNK_MIN_SIZE && (hash & CHUNK_ROW_MASK) == 0) ||
+            writer->text_size >= CHUNK_MAX_SIZE) {
+            break;
+        }
+    }
+    if (writer->text_size == 0) {
+        return row;  // only dead rows, nothing to store
+    }
+
+    BackupChunk chunk;
+    chunk.first_row = first_row;
+    chunk.changed = 0;
+    chunk_name(writer->text, writer->text_size, chunk.name, sizeof(chunk.name));
+    strcat(chunk.name, CHUNK_CODEC_EXT);
+
+    char path[128];
+    snprintf(path, sizeof(path), "%s/%s", BACKUP_CHUNK_DIR, chunk.name);
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        char temp_path[140];
+        snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+        size_t bound = chunk_bound(writer->text_size);
+        if (bound > writer->packed_capacity) {
+            writer->packed_capacity = bound;
+            writer->packed = realloc(writer->packed, bound);
+            if (!writer->packed) {
+                printf("Memory reallocation failed!!\n");
+                exit(1);
+            }
+        }
+        size_t packed_size = chunk_compress(writer->text, writer->text_size, writer->packed);
+
+        // Synced before the rename, like save_reviews_to_csv(). A chunk that
+        // didn't pack fails the backup, the name already says it is packed.
+        FILE *file = packed_size > 0 ? fopen(temp_path, "w") : NULL;
+        int ok = file && fwrite(writer->packed, packed_size, 1, file) == 1 &&
+                 fflush(file) == 0 && fsync(fileno(file)) == 0;
+        if (file && fclose(file) != 0) ok = 0;
+        if (!ok || rename(temp_path, path) != 0) {
+            remove(temp_path);
+            writer->ok = 0;
+        }
+        writer->new_chunks++;
+        writer->new_bytes += packed_size;
+    }
+    backup_list_chunk(writer, &chunk);
+    return row;
+}
+
+// Reuse a chunk of the last backup as it is. Returns 0 if it has gone from
+// the store since (the caller writes it again).
+int backup_keep_chunk(BackupWriter *writer, const BackupChunk *chunk) {
+    char path[128];
+    snprintf(path, sizeof(path), "%s/%s", BACKUP_CHUNK_DIR, chunk->name);
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return 0;
+    }
+    backup_list_chunk(writer, chunk);
+    return 1;
+}
+
+// Add a chunk to the manifest and to the chunk list of this backup
+void backup_list_chunk(BackupWriter *writer, const BackupChunk *chunk) {
+    if (writer->chunk_count >= writer->chunk_capacity) {
+        writer->chunk_capacity = writer->chunk_capacity ? writer->chunk_capacity * 2 : 64;
+        writer->chunks = (BackupChunk*)realloc(writer->chunks, writer->chunk_capacity * sizeof(BackupChunk));
+        if (!writer->chunks) {
+            printf("Memory reallocation failed!!\n");
+            exit(1);
+        }
+    }
+    writer->chunks[writer->chunk_count++] = *chunk;
+    if (fprintf(writer->manifest, "%s\n", chunk->name) < 0) writer->ok = 0;
+}
+
+void backup_append(BackupWriter *writer, const char *data, size_t length) {
+    backup_reserve(writer, length);
+    memcpy(writer->text + writer->text_size, data, length);
+    writer->text_size += length;
+}
+
+// Make room for bytes more in writer->text
+void backup_reserve(BackupWriter *writer, size_t bytes) {
+    if (writer->text_size + bytes > writer->text_capacity) {
+        while (writer->text_size + bytes > writer->text_capacity) {
+            writer->text_capacity = writer->text_capacity ? writer->text_capacity * 2 : CHUNK_MAX_SIZE;
+        }
+        writer->text = realloc(writer->text, writer->text_capacity);
+        if (!writer->text) {
+            printf("Memory reallocation failed!!\n");
+            exit(1);
+        }
+    }
+}
+
+// Content name of a chunk: CRC32C, 64-bit FNV-1a and the length, in hex
+void chunk_name(const char *data, size_t length, char *name, size_t name_size) {
+    uint64_t fnv = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; i++) {
+        fnv ^= (unsigned char)data[i];
+        fnv *= 1099511628211ULL;
+    }
+    snprintf(name, name_size, "%08x%016llx-%zx", crc32c(0, data, length), (unsigned long long)fnv, length);
+}
+
+// Compress a chunk with this build's codec (CHUNK_CODEC_EXT) into dst,
+// which has room for chunk_bound(length) bytes. Returns the packed size,
+// 0 if the codec failed (a chunk is never empty).
+size_t chunk_compress(const char *src, size_t length, char *dst) {
+#ifdef HAVE_ZLIB
+    // One deflate stream for the whole run, reset per chunk (setting one
+    // up costs more than packing a small chunk)
+    static z_stream stream;
+    static int stream_ready = 0;
+    if (!stream_ready) {
+        if (deflateInit2(&stream, CHUNK_ZLIB_LEVEL, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            printf("Memory allocation failed!\n");
+            exit(1);
+        }
+        stream_ready = 1;
+    }
+    deflateReset(&stream);
+    stream.next_in = (Bytef*)src;
+    stream.avail_in = length;
+    stream.next_out = (Bytef*)dst;
+    stream.avail_out = chunk_bound(length);
+    if (deflate(&stream, Z_FINISH) != Z_STREAM_END) {
+        return 0;  // dst is big enough for anything, so the stream itself broke
+    }
+    return chunk_bound(length) - stream.avail_out;
+#else
+    return lz_compress((const unsigned char*)src, length, (unsigned char*)dst);
+#endif
+}
+
+size_t chunk_bound(size_t length) {
+#ifdef HAVE_ZLIB
+    return compressBound(length);
+#else
+    return length + length / 255 + 16;
+#endif
+}
+
+// Unpack a chunk file into dst, exactly length bytes. ext says how it was
+// packed (NULL = stored as is). Returns 0 on success.
+int chunk_decompress(const char *ext, const char *src, size_t packed, char *dst, size_t length) {
+    if (!ext) {
+        if (packed != length) return -1;
+        memcpy(dst, src, length);
+        return 0;
+    }
+    if (strcmp(ext, ".lz") == 0) {
+        return lz_decompress((const unsigned char*)src, packed, (unsigned char*)dst, length);
+    }
+#ifdef HAVE_ZLIB
+    if (strcmp(ext, ".z") == 0) {
+        static z_stream stream;
+        static int stream_ready = 0;
+        if (!stream_ready) {
+            if (inflateInit2(&stream, -15) != Z_OK) {
+                printf("Memory allocation failed!\n");
+                exit(1);
+            }
+            stream_ready = 1;
+        }
+        inflateReset(&stream);
+        stream.next_in = (Bytef*)src;
+        stream.avail_in = packed;
+        stream.next_out = (Bytef*)dst;
+        stream.avail_out = length;
+        return inflate(&stream, Z_FINISH) == Z_STREAM_END && stream.avail_out == 0 ? 0 : -1;
+    }
+#endif
+    printf("❌ This build cannot read %s chunks (built without zlib?)\n", ext);
+    return -1;
+}
+
+// Built-in LZ codec, LZ4 style: a run of sequences, each
+//   token (literal count << 4 | match length - 4), more literal count,
+//   the literals, match offset (2 bytes), more match length
+// where a count of 15 in the token goes on in the next bytes (255 = add
+// and keep going). The last sequence has literals only. Matches are found
+// through a hash of the next 4 bytes, one candidate per hash.
+size_t lz_compress(const unsigned char *src, size_t length, unsigned char *dst) {
+    int32_t table[1 << LZ_HASH_BITS];
+    memset(table, 0xff, sizeof(table));
+
+    size_t in = 0, anchor = 0, out = 0;
+    while (in + LZ_MIN_MATCH <= length) {
+        uint32_t sequence, candidate_sequence;
+        memcpy(&sequence, src + in, 4);
+        uint32_t hash = (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+        int32_t candidate = table[hash];
+        table[hash] = (int32_t)in;
+        if (candidate < 0 || in - candidate > 65535 ||
+            (memcpy(&candidate_sequence, src + candidate, 4), candidate_sequence != sequence)) {
+            in++;
+            continue;
+        }
+
+        size_t match = LZ_MIN_MATCH;
+        while (in + match < length && src[candidate + match] == src[in + match]) match++;
+        out = lz_sequence(dst, out, src + anchor, in - anchor, in - candidate, match);
+        in += match;
+        anchor = in;
+    }
+    return lz_sequence(dst, out, src + anchor, length - anchor, 0, 0);
+}
+
+// Write one sequence (match = 0: literals only), returns the new end of dst
+size_t lz_sequence(unsigned char *dst, size_t out, const unsigned char *literals, size_t literal_count,
+                   size_t offset, size_t match) {
+    size_t extra = match ? match - LZ_MIN_MATCH : 0;
+    dst[out++] = (unsigned char)((literal_count < 15 ? literal_count : 15) << 4 | (extra < 15 ? extra : 15));
+    if (literal_count >= 15) {
+        size_t rest = literal_count - 15;
+        for (; rest >= 255; rest -= 255) dst[out++] = 255;
+        dst[out++] = (unsigned char)rest;
+    }
+    memcpy(dst + out, literals, literal_count);
+    out += literal_count;
+    if (match) {
+        dst[out++] = offset & 0xFF;
+        dst[out++] = offset >> 8;
+        if (extra >= 15) {
+            size_t rest = extra - 15;
+            for (; rest >= 255; rest -= 255) dst[out++] = 255;
+            dst[out++] = (unsigned char)rest;
+        }
+    }
+    return out;
+}
+
+// Unpack lz_compress() output into exactly length bytes, checking every
+// count and offset against both buffers. Returns 0 on success.
+int lz_decompress(const unsigned char *src, size_t packed, unsigned char *dst, size_t length) {
+    size_t in = 0, out = 0;
+    while (in < packed) {
+        unsigned char token = src[in++];
+        size_t literal_count = token >> 4;
+        if (literal_count == 15) {
+            unsigned char more;
+            do {
+                if (in >= packed) return -1;
+                more = src[in++];
+                literal_count += more;
+            } while (more == 255);
+        }
+        if (literal_count > packed - in || literal_count > length - out) return -1;
+        memcpy(dst + out, src + in, literal_count);
+        in += literal_count;
+        out += literal_count;
+        if (in == packed) break;  // last sequence
+
+        if (packed - in < 2) return -1;
+        size_t offset = src[in] | (size_t)src[in + 1] << 8;
+        in += 2;
+        size_t match = (token & 15) + LZ_MIN_MATCH;
+        if ((token & 15) == 15) {
+            unsigned char more;
+            do {
+                if (in >= packed) return -1;
+                more = src[in++];
+                match += more;
+            } while (more == 255);
+        }
+        if (offset == 0 || offset > out || match > length - out) return -1;
+        for (size_t i = 0; i < match; i++, out++) {
+            dst[out] = dst[out - offset];  // may overlap, byte by byte
+        }
+    }
+    return out == length ? 0 : -1;
+}
+
+// Note that a row's text changed since the last backup
+void mark_row_changed(int index) {
+    review_changed[index / 64] |= 1ULL << (index % 64);
+}
+
+// Did any row in [from, to) change since the last backup? A word at a time.
+int any_row_changed(int from, int to) {
+    while (from < to && from % 64) {
+        if ((review_changed[from / 64] >> (from % 64)) & 1) return 1;
+        from++;
+    }
+    for (; from + 64 <= to; from += 64) {
+        if (review_changed[from / 64]) return 1;
+    }
+    for (; from < to; from++) {
+        if ((review_changed[from / 64] >> (from % 64)) & 1) return 1;
+    }
+    return 0;
+}
+
+// Renumber the last backup's chunks after a compaction. Rows that were
+// already dead at that backup go without changing any text, the chunks of
+// rows deleted since were flagged by backup_drop_row().
+void backup_remap_rows(const int *new_row) {
+    int kept = 0, chunk = 0;
+    for (int row = 0; row < backup_rows; row++) {
+        while (chunk < backup_chunk_count && backup_chunks[chunk].first_row == row) {
+            backup_chunks[chunk++].first_row = kept;
+        }
+        if (new_row[row] >= 0) kept++;
+    }
+    backup_rows = kept;
+}
+
+// A changed row is going away in a compaction: its chunk has to be cut again
+void backup_drop_row(int row) {
+    if (row >= backup_rows) return;
+    int low = 0, high = backup_chunk_count - 1;
+    while (low < high) {  // last chunk starting at or before row
+        int mid = (low + high + 1) / 2;
+        if (backup_chunks[mid].first_row <= row) low = mid;
+        else high = mid - 1;
+    }
+    if (backup_chunk_count > 0) backup_chunks[low].changed = 1;
+}
+
+// Forget the last backup, the next one reads every row again
+void backup_forget() {
+    free(backup_chunks);
+    backup_chunks = NULL;
+    backup_chunk_count = backup_chunk_capacity = backup_rows = 0;
+}
+
+// Walk the chunks a manifest lists in order: read and unpack each one, check
+// it against its name (verify = 1) and hand its text to visit (NULL = none).
+// One chunk is in memory at a time. Returns 0 if every chunk was good.
+int manifest_read_chunks(const char *manifest_path, int verify, ChunkCallback visit, void *context) {
+    FILE *manifest = fopen(manifest_path, "r");
+    if (!manifest) {
+        return -1;
+    }
+
+    char line[128];
+    int ok = fgets(line, sizeof(line), manifest) && strncmp(line, BACKUP_MAGIC, strlen(BACKUP_MAGIC)) == 0;
+    char *packed = NULL, *text = NULL;
+    size_t packed_capacity = 0, text_capacity = 0;
+    while (ok && fgets(line, sizeof(line), manifest)) {
+        line[strcspn(line, "\n")] = 0;
+        if (line[0] == '\0') continue;
+
+        // "<crc><fnv>-<length in hex>[.codec]"
+        char *dash = strchr(line, '-');
+        char *ext = strchr(line, '.');
+        size_t length = dash ? strtoull(dash + 1, NULL, 16) : 0;
+        if (!dash || length == 0 || length > CHUNK_MAX_SIZE * 64) {
+            printf("❌ Bad line in %s: %s\n", manifest_path, line);
+            ok = 0;
+            break;
+        }
+
+        char path[200];
+        snprintf(path, sizeof(path), "%s/%s", BACKUP_CHUNK_DIR, line);
+        FILE *file = fopen(path, "r");
+        struct stat st;
+        if (!file || fstat(fileno(file), &st) != 0) {
+            printf("❌ Missing backup chunk %s\n", line);
+            if (file) fclose(file);
+            ok = 0;
+            break;
+        }
+        if ((size_t)st.st_size > packed_capacity) {
+            packed_capacity = st.st_size;
+            packed = realloc(packed, packed_capacity);
+        }
+        if (length + 1 > text_capacity) {
+            text_capacity = length + 1;
+            text = realloc(text, text_capacity);
+        }
+        if (!packed || !text) {
+            printf("Memory reallocation failed!!\n");
+            exit(1);
+        }
+        size_t packed_size = fread(packed, 1, st.st_size, file);
+        fclose(file);
+
+        char check[64];
+        int unpacked = chunk_decompress(ext, packed, packed_size, text, length) == 0;
+        if (unpacked && verify) {
+            chunk_name(text, length, check, sizeof(check));
+            if (ext) *ext = '\0';  // compare the content name only
+            unpacked = strcmp(check, line) == 0;
+        }
+        if (!unpacked) {
+            printf("❌ Backup chunk %s is damaged\n", line);
+            ok = 0;
+            break;
+        }
+        if (visit) visit(text, length, context);
+    }
+    free(packed);
+    free(text);
+    fclose(manifest);
+    return ok ? 0 : -1;
+}
+
+// Load the rows of a manifest straight from its chunks, a line at a time.
+// The chunks are not hashed again, restore_from_backup() just checked them.
+int load_reviews_manifest(const char *manifest_path) {
+    ManifestLoad load;
+    memset(&load, 0, sizeof(load));
+    load.skip_header = 1;
+    skipped_rows = 0;
+    int result = manifest_read_chunks(manifest_path, 0, load_chunk_rows, &load);
+    if (result == 0 && load.partial_size > 0) {
+        load_manifest_line(&load, load.partial);  // last record had no '\n'
+    }
+    free(load.partial);
+    report_skipped_rows();
+    return result;
+}
+
+// ChunkCallback of load_reviews_manifest(), also fed the blocks of a plain
+// CSV. A record cut by a chunk border (a '\n' in quotes does not end one) is
+// put back together in load->partial.
+void load_chunk_rows(char *text, size_t length, void *context) {
+    ManifestLoad *load = context;
+    char *end = text + length;
+    while (text < end) {
+        char *newline = load->plain_lines ? memchr(text, '\n', end - text)
+                                          : csv_find_record_end(text, end, &load->scan);
+        size_t line_length = newline ? (size_t)(newline - text) : (size_t)(end - text);
+        if (!newline || load->partial_size > 0) {
+            if (load->partial_size + line_length + 1 > load->partial_capacity) {
+                load->partial_capacity = (load->partial_size + line_length + 1) * 2;
+                load->partial = realloc(load->partial, load->partial_capacity);
+                if (!load->partial) {
+                    printf("Memory reallocation failed!!\n");
+                    exit(1);
+                }
+            }
+            memcpy(load->partial + load->partial_size, text, line_length);
+            load->partial_size += line_length;
+            load->partial[load->partial_size] = '\0';
+            if (!newline) return;  // the rest comes with the next chunk
+
+            load_manifest_line(load, load->partial);
+            load->partial_size = 0;
+        } else {
+            *newline = '\0';
+            load_manifest_line(load, text);
+        }
+        text = newline + 1;
+    }
+}
+
+void load_manifest_line(ManifestLoad *load, char *line) {
+    if (load->skip_header) {
+        load->skip_header = 0;
         return;
     }
-    
-    int exactCount = 0, closeCount = 0, fuzzyCount = 0;
-    
-    for (int i = 0; i < resultCount; i++) {
-        if (strcmp(results[i].matchType, "exact") == 0) exactCount++;
-        else if (strcmp(results[i].matchType, "close") == 0) closeCount++;
-        else fuzzyCount++;
+    if (load->visit_line) {
+        load->visit_line(line, load->context);
+    } else {
+        store_loaded_review(line, 1);
     }
+}
+
+int is_backup_manifest(const char *filename) {
+    FILE *file = fopen(filename, "r");
+    if (!file) return 0;
+    char line[32];
+    int manifest = fgets(line, sizeof(line), file) && strncmp(line, BACKUP_MAGIC, strlen(BACKUP_MAGIC)) == 0;
+    fclose(file);
+    return manifest;
+}
+
+int restore_from_backup(const char *filename) {
+    printf("⚠️  This will replace current data!\n");
+    printf("Continue? (y/n): ");
+    char confirm;
+    scanf(" %c", &confirm);
+    getchar();
     
-    // Display exact matches
-    if (exactCount > 0) {
-        printf("\n✅ Exact Matches (%d):\n", exactCount);
-        for (int i = 0; i < resultCount; i++) {
-            if (strcmp(results[i].matchType, "exact") == 0) {
-                int idx = results[i].index;
-                printf("  %d. %s (Score: %d/5, Date: %s)\n",
-                       idx + 1,
-                       reviews[idx].reviewer_name,
-                       reviews[idx].satisfaction_score,
-                       reviews[idx].review_date);
-                printf("     💬 %s\n", reviews[idx].feedback);
-            }
-        }
+    if (confirm != 'y' && confirm != 'Y') {
+        printf("Restore cancelled.\n");
+        return -1;
     }
     
-    // Display close matches
-    if (closeCount > 0) {
-        printf("\n🔍 Close Matches (%d) - Did you mean?\n", closeCount);
-        for (int i = 0; i < resultCount; i++) {
-            if (strcmp(results[i].matchType, "close") == 0) {
-                int idx = results[i].index;
-                printf("  %d. %s (Edit distance: %d)\n",
-                       idx + 1,
-                       reviews[idx].reviewer_name,
-                       results[i].distance);
-                printf("     Score: %d/5 | Date: %s\n",
-                       reviews[idx].satisfaction_score,
-                       reviews[idx].review_date);
-            }
-        }
+    // Every chunk of a manifest is checked first, while the current data is still there
+    int manifest = is_backup_manifest(filename);
+    if (manifest && manifest_read_chunks(filename, 1, NULL, NULL) != 0) {
+        printf("❌ Failed to restore backup!\n");
+        return -1;
     }
+
+    // Free current data
+    free_all_memory();
+    initialize_system();
     
-    // Display fuzzy matches
-    if (fuzzyCount > 0) {
-        printf("\n💡 Similar Names (%d):\n", fuzzyCount);
-        for (int i = 0; i < resultCount; i++) {
-            if (strcmp(results[i].matchType, "fuzzy") == 0) {
-                int idx = results[i].index;
-                printf("  %d. %s (Distance: %d)\n",
-                       idx + 1,
-                       reviews[idx].reviewer_name,
-                       results[i].distance);
-            }
+    int loaded = manifest ? load_reviews_manifest(filename) : load_reviews_from_csv(filename);
+    if (loaded == 0) {
+        printf("✅ Data restored from: %s\n", filename);
+        // The old log is for the data we just dropped
+        if (wal_fd >= 0 && wal_checkpoint() != 0) {
+            printf("❌ Failed to save data!\n");
         }
+        return 0;
+    } else {
+        printf("❌ Failed to restore backup!\n");
+        return -1;
     }
-    
-    free(results);
 }
+// streaming report
+// Statistics, score/date filters and a name search over a CSV or a backup
+// manifest in one pass, without loading it: the file goes through a
+// STREAM_BLOCK_SIZE buffer (a manifest a chunk at a time) and only running
+// totals are kept, so files larger than memory work. The table is not touched.
 
-SearchResult* searchWithTypoCorrection(const char* query, int* resultCount, int maxDistance) {
-    if (!query || review_count == 0) {
-        *resultCount = 0;
-        return NULL;
-    }
+void stream_report_menu() {
+    StreamReport report;
+    memset(&report, 0, sizeof(report));
+    report.max_score = 255;
 
-    // allocate results array
-    SearchResult* results = malloc(review_count * sizeof(SearchResult));
-    if (!results) {
-        *resultCount = 0;
-        return NULL;
+    char filename[256], input[128];
+    printf("Enter CSV or backup manifest filename: ");
+    fgets(filename, sizeof(filename), stdin);
+    filename[strcspn(filename, "\n")] = 0;
+    trim_whitespace(filename);
+
+    // Every filter is optional, Enter skips it
+    int scores[2] = {0, 255};
+    const char *score_prompts[2] = {"Minimum score (1-5, Enter = any): ", "Maximum score (1-5, Enter = any): "};
+    for (int i = 0; i < 2; i++) {
+        printf("%s", score_prompts[i]);
+        fgets(input, sizeof(input), stdin);
+        input[strcspn(input, "\n")] = 0;
+        trim_whitespace(input);
+        if (strlen(input) == 0) continue;
+        char *endptr;
+        long score = strtol(input, &endptr, 10);
+        if (*endptr != '\0' || score < 1 || score > 5) {
+            printf("❌ Score must be between 1 and 5.\n");
+            return;
+        }
+        scores[i] = (int)score;
+        report.show_rows = 1;
     }
+    report.min_score = scores[0];
+    report.max_score = scores[1];
 
-    *resultCount = 0;
-    char* lowerQuery = toLowerCase(query);
-    
-    // find match
-    for (int i = 0; i < review_count; i++) {
-        char* lowerName = toLowerCase(reviews[i].reviewer_name);
-        // calculate edit distance
-        int distance = editDistance(lowerQuery, lowerName);
-
-        if (distance <= maxDistance) {
-            results[*resultCount].index = i;
-            results[*resultCount].distance = distance;
-
-            if (distance == 0) {
-                strcpy(results[*resultCount].matchType, "exact");
-            } else if (distance == 2) {
-                strcpy(results[*resultCount].matchType, "close");
-            } else {
-                strcpy(results[*resultCount].matchType, "fuzzy");
-            }
-            (*resultCount)++;
+    int32_t days[2] = {INT32_MIN, INT32_MAX};
+    const char *date_prompts[2] = {"Start date (YYYY-MM-DD, Enter = any): ", "End date (YYYY-MM-DD, Enter = any): "};
+    for (int i = 0; i < 2; i++) {
+        printf("%s", date_prompts[i]);
+        fgets(input, sizeof(input), stdin);
+        input[strcspn(input, "\n")] = 0;
+        trim_whitespace(input);
+        if (strlen(input) == 0) continue;
+        int32_t key = pack_date(input);
+        if (!key) {
+            printf("❌ Invalid date! Use YYYY-MM-DD.\n");
+            return;
         }
-        free(lowerName);
+        days[i] = day_number(key);
+        report.filter_dates = 1;
+        report.show_rows = 1;
     }
-    free(lowerQuery);
+    report.first_day = days[0];
+    report.last_day = days[1];
 
-    // result sorted by distance from (best matches first)
-    for (int i = 0; i < *resultCount - 1; i++) {
-        for (int j = 0; j < *resultCount - i - 1; j++) {
-            if (results[j].distance > results[j+1].distance) {
-                // structType VariableName = array[x] ; in this case "temp" is auto clear, just like int i = 5
-                SearchResult temp = results[j];
-                results[j] = results[j+1];
-                results[j+1] = temp;
-            }
+    char query[100];
+    printf("Reviewer name (Enter = any): ");
+    fgets(query, sizeof(query), stdin);
+    query[strcspn(query, "\n")] = 0;
+    trim_whitespace(query);
+    char *folded_query = NULL;
+    if (strlen(query) > 0) {
+        folded_query = toLowerCase(query);
+        if (!folded_query) {
+            printf("Memory allocation failed!\n");
+            exit(1);
         }
+        report.query = folded_query;
+        report.max_edits = partial_tolerance(strlen(folded_query));
+        report.show_rows = 1;
     }
-    return results;
+
+    printf("\n=== Streaming %s ===\n", filename);
+    int result = stream_report(filename, &report);
+    if (result != 0 && report.rows == 0) {
+        printf("❌ Cannot read %s!\n", filename);
+    } else {
+        if (result != 0) printf("\n⚠️  Stopped early, the totals only cover the rows read so far.\n");
+        print_stream_report(&report);
+    }
+    free(folded_query);
+    free(report.folded);
 }
 
-// delete
+// Read filename (CSV or manifest) record by record into stream_report_line().
+// Memory stays at one read buffer (or chunk) and the longest record.
+// Returns 0 if the whole file was read.
+int stream_report(const char *filename, StreamReport *report) {
+    ManifestLoad lines;
+    memset(&lines, 0, sizeof(lines));
+    lines.skip_header = 1;
+    lines.visit_line = stream_report_line;
+    lines.context = report;
 
-void enhanced_delete_menu() {
-    printf("\n╔════════════════════════════════════════╗\n");
-    printf("║         🗑️  Delete Options             ║\n");
-    printf("╚════════════════════════════════════════╝\n");
-    printf("1. Delete by name\n");
-    printf("2. Delete by selecting from list\n");
-    printf("3. Delete all reviews by a user\n");
-    printf("4. Back to main menu\n");
-    printf("Choice: ");
-    
-    int choice;
-    scanf("%d", &choice);
-    getchar();
-    
-    switch(choice) {
-        case 1:
-            delete_review_by_name();
-            break;
-        case 2:
-            delete_by_selection();
-            break;
-        case 3:
-            delete_all_by_user();
-            break;
-        case 4:
-            return;
-        default:
-            printf("Invalid choice!\n");
+    int result;
+    if (is_backup_manifest(filename)) {
+        result = manifest_read_chunks(filename, 1, load_chunk_rows, &lines);
+    } else {
+        result = read_csv_records(filename, &lines);
     }
+    if (lines.partial_size > 0) {
+        load_manifest_line(&lines, lines.partial);  // last record had no '\n'
+    }
+    free(lines.partial);
+    return result;
 }
 
-void delete_review_by_name() {
-    if (review_count == 0) {
-        printf("No reviews to delete.\n");
+// LineCallback of stream_report(): filter one row, count it and print it
+void stream_report_line(char *line, void *context) {
+    StreamReport *report = context;
+    char *fields[4];
+    // Same conversions as the loaders, so the numbers match show_statistics()
+    int score = split_review_line(line, fields) ? loaded_score(fields[1]) : -1;
+    if (score < 0) {
+        report->skipped++;
         return;
     }
+    report->rows++;
 
-    char search_name[256];
-    printf("\n=== Delete Review ===\n");
-    printf("Enter reviewer name to delete: ");
-    fgets(search_name, sizeof(search_name), stdin);
-    search_name[strcspn(search_name, "\n")] = 0;
+    if (score < report->min_score || score > report->max_score) return;
+    int32_t key = pack_date(fields[2]);
+    int32_t day = key ? day_number(key) : 0;
+    if (report->filter_dates && (!key || day < report->first_day || day > report->last_day)) return;
+    if (report->query && !stream_name_matches(report, fields[0])) return;
 
-    // Use typo correction to find matches
-    int resultCount;
-    SearchResult* results = searchWithTypoCorrection(search_name, &resultCount, 3);
-    
-    if (resultCount == 0) {
-        printf("Review not found!\n");
-        free(results);
-        return;
+    if (report->matched++ == 0) {
+        report->min_score_seen = report->max_score_seen = score;
     }
-    
-    // If multiple matches, show them
-    if (resultCount > 1) {
-        printf("\nMultiple matches found:\n");
-        for (int i = 0; i < resultCount; i++) {
-            int idx = results[i].index;
-            printf("%d. %s (Score: %d/5, Date: %s)\n",
-                   i + 1,
-                   reviews[idx].reviewer_name,
-                   reviews[idx].satisfaction_score,
-                   reviews[idx].review_date);
-        }
-        printf("\nSelect review to delete (1-%d), or 0 to cancel: ", resultCount);
-        int choice;
-        scanf("%d", &choice);
-        getchar();
-        
-        if (choice < 1 || choice > resultCount) {
-            printf("Delete cancelled.\n");
-            free(results);
-            return;
-        }
-        
-        delete_review_at_index(results[choice - 1].index);
+    if (score >= 1 && score <= 5) {
+        report->counts[score - 1]++;
+        report->sum += score;
     } else {
-        // Single match - confirm and delete
-        int idx = results[0].index;
-        printf("Found review:\n");
-        printf("Reviewer: %s\n", reviews[idx].reviewer_name);
-        printf("Score: %d/5\n", reviews[idx].satisfaction_score);
-        printf("Date: %s\n", reviews[idx].review_date);
-        printf("Feedback: %s\n", reviews[idx].feedback);
-        
-        char confirm;
-        printf("Are you sure you want to delete this review? (y/n): ");
-        scanf(" %c", &confirm);
-        getchar();
-        
-        if (confirm == 'y' || confirm == 'Y') {
-            delete_review_at_index(idx);
-        } else {
-            printf("Deletion cancelled.\n");
+        report->out_of_range++;
+    }
+    if (score < report->min_score_seen) report->min_score_seen = score;
+    if (score > report->max_score_seen) report->max_score_seen = score;
+    if (key && (!report->first_seen || day < report->first_seen)) {
+        report->first_seen = day;
+        snprintf(report->first_date, sizeof(report->first_date), "%s", fields[2]);
+    }
+    if (key && (!report->last_seen || day > report->last_seen)) {
+        report->last_seen = day;
+        snprintf(report->last_date, sizeof(report->last_date), "%s", fields[2]);
+    }
+
+    if (report->show_rows) {
+        printf("  %lld. %s (Score: %d/5, Date: %s)\n", report->matched, fields[0], score, fields[2]);
+        printf("     💬 %s\n", fields[3]);
+    }
+}
+
+// Name filter of a report, the same rules as search_reviews(): within 3 edits
+// of the whole name, or a close match for part of it
+int stream_name_matches(StreamReport *report, const char *name) {
+    size_t size = strlen(name) + 1;
+    if (size > report->folded_capacity) {
+        report->folded_capacity = size * 2;
+        report->folded = realloc(report->folded, report->folded_capacity);
+        if (!report->folded) {
+            printf("Memory reallocation failed!!\n");
+            exit(1);
         }
     }
-    
-    free(results);
+    fold_case(report->folded, name, size);
+    return editDistanceWithin(report->query, report->folded, 3) <= 3 ||
+           partialDistanceWithin(report->query, report->folded, report->max_edits) <= report->max_edits;
 }
 
-void delete_by_selection() {
-    if (review_count == 0) {
-        printf("No reviews to delete.\n");
-        return;
+void print_stream_report(const StreamReport *report) {
+    printf("\n╔════════════════════════════════════════╗\n");
+    printf("║         📊 Streaming Report            ║\n");
+    printf("╚════════════════════════════════════════╝\n");
+    printf("Rows read: %lld\n", report->rows);
+    if (report->skipped > 0) {
+        printf("Skipped lines: %lld\n", report->skipped);
     }
-    
-    display_all_reviews();
-    
-    printf("\nEnter review number to delete (1-%d): ", review_count);
-    int choice;
-    scanf("%d", &choice);
-    getchar();
-    
-    if (choice < 1 || choice > review_count) {
-        printf("Invalid choice!\n");
+    printf("Matching Reviews: %lld\n", report->matched);
+    if (report->matched == 0) {
         return;
     }
-    
-    delete_review_at_index(choice - 1);
+
+    printf("Average Score: %.2f/5\n", (double)report->sum / report->matched);
+    printf("Lowest/Highest: %d/%d\n", report->min_score_seen, report->max_score_seen);
+    if (report->out_of_range > 0) {
+        printf("Out of range scores: %lld\n", report->out_of_range);
+    }
+    if (report->first_seen) {
+        printf("Dates: %s to %s\n", report->first_date, report->last_date);
+    }
+    printf("\n");
+
+    printf("Score Distribution:\n");
+    for (int i = 4; i >= 0; i--) {
+        printf("%d ⭐ ", i + 1);
+        int bars = (int)(report->counts[i] * 20 / report->matched);
+        for (int j = 0; j < bars; j++) printf("█");
+        printf(" (%lld)\n", report->counts[i]);
+    }
 }
 
-void delete_all_by_user() {
-    if (review_count == 0) {
-        printf("No reviews to delete.\n");
+// bulk import
+// Add the reviews of another file to the table: a CSV, an NDJSON file (one
+// JSON object per line) or a backup manifest. The file is read twice: once
+// to count its lines, so the columns grow once, then a STREAM_BLOCK_SIZE
+// block (or chunk) at a time. Rows that fail the Add Review checks are
+// counted and skipped. A merge also skips rows whose (name, date, feedback)
+// is already in the table or earlier in the file, through a hash set of
+// those keys. The whole import is one undo step.
+
+void import_menu() {
+    char filename[256], answer[16];
+    printf("Enter CSV, NDJSON or backup manifest filename: ");
+    fgets(filename, sizeof(filename), stdin);
+    filename[strcspn(filename, "\n")] = 0;
+    trim_whitespace(filename);
+
+    printf("Skip reviews already here (same name, date and feedback)? (y/n): ");
+    fgets(answer, sizeof(answer), stdin);
+    int skip_duplicates = answer[0] == 'y' || answer[0] == 'Y';
+
+    ImportRun run;
+    if (import_reviews(filename, skip_duplicates, &run) != 0) {
+        printf("❌ Cannot import %s\n", filename);
         return;
     }
-    
-    char search_name[256];
-    printf("Enter reviewer name: ");
-    fgets(search_name, sizeof(search_name), stdin);
-    search_name[strcspn(search_name, "\n")] = 0;
-    
-    int deleted_count = 0;
-    for (int i = review_count - 1; i >= 0; i--) {
-        if (strcmp(reviews[i].reviewer_name, search_name) == 0) {
-            free(reviews[i].reviewer_name);
-            free(reviews[i].review_date);
-            free(reviews[i].feedback);
-            
-            for (int j = i; j < review_count - 1; j++) {
-                reviews[j] = reviews[j + 1];
-            }
-            review_count--;
-            deleted_count++;
-        }
+    printf("✅ Imported %d review(s) from %s\n", run.added, filename);
+    if (run.invalid > 0) {
+        printf("   %d invalid row(s) skipped\n", run.invalid);
     }
-    
-    if (deleted_count > 0) {
-        printf("✅ Deleted %d review(s) by %s\n", deleted_count, search_name);
-    } else {
-        printf("❌ No reviews found for %s\n", search_name);
+    if (run.duplicates > 0) {
+        printf("   %d duplicate(s) skipped\n", run.duplicates);
+    }
+    if (run.added > 0) {
+        printf("💡 Tip: Use menu option 8 to undo the whole import.\n");
     }
 }
 
-void delete_review_at_index(int index) {
-    if (index < 0 || index >= review_count) {
-        printf("Invalid index!\n");
-        return;
+// Returns 0 with the counts in run, -1 if the file can't be read (nothing
+// is added then)
+int import_reviews(const char *filename, int skip_duplicates, ImportRun *run) {
+    memset(run, 0, sizeof(ImportRun));
+    int manifest = is_backup_manifest(filename);
+    run->ndjson = !manifest && is_ndjson_file(filename);
+    run->first_record = 1;
+    run->skip_duplicates = skip_duplicates;
+
+    // Every chunk of a manifest is checked here, before anything is added
+    long long records = count_import_records(filename, manifest);
+    if (records < 0 || records > INT_MAX - review_count) {
+        return -1;
     }
-    
-    printf("\n⚠️  You are about to delete:\n");
-    display_full_review(index);
-    
-    printf("\n❗ Type 'DELETE' to confirm: ");
-    char confirm[20];
-    scanf("%s", confirm);
-    getchar();
-    
-    if (strcmp(confirm, "DELETE") == 0) {
-        // Save for undo (make copies before freeing!)
-        if (has_deleted) {
-            // Free previous undo if exists
-            free(last_deleted_review.reviewer_name);
-            free(last_deleted_review.review_date);
-            free(last_deleted_review.feedback);
+    reserve_reviews(review_count + (int)records);
+    if (records > IMPORT_REINDEX_ROWS) {
+        name_index_free();
+        date_index_free();
+        bk_free();
+    }
+    if (skip_duplicates) {
+        key_set_init(&run->keys, live_review_count() + records);
+        for (int row = 0; row < review_count; row++) {
+            if (!is_review_live(row)) continue;
+            key_set_add(&run->keys, row, review_names[row], review_dates[row], review_feedbacks[row]);
         }
-        
-        // store this thing for undo later on
-        last_deleted_review.reviewer_name = allocate_string(reviews[index].reviewer_name);
-        last_deleted_review.satisfaction_score = reviews[index].satisfaction_score;
-        last_deleted_review.review_date = allocate_string(reviews[index].review_date);
-        last_deleted_review.feedback = allocate_string(reviews[index].feedback);
-        last_deleted_position = index;
-        has_deleted = 1;
-        
-        // Now delete
-        free(reviews[index].reviewer_name);
-        free(reviews[index].review_date);
-        free(reviews[index].feedback);
-        
-        for (int i = index; i < review_count - 1; i++) {
-            reviews[i] = reviews[i + 1];
+    }
+
+    ManifestLoad load;
+    memset(&load, 0, sizeof(load));
+    load.plain_lines = run->ndjson;
+    load.visit_line = import_record;
+    load.context = run;
+    int first_row = review_count;
+    int result = manifest ? manifest_read_chunks(filename, 0, load_chunk_rows, &load)
+                          : read_csv_records(filename, &load);
+    if (result == 1) {
+        result = 0;  // an empty file, nothing to add
+    }
+    if (result == 0 && load.partial_size > 0) {
+        load_manifest_line(&load, load.partial);  // last record had no '\n'
+    }
+    free(load.partial);
+    key_set_free(&run->keys);
+
+    if (result != 0) {
+        for (int row = first_row; row < review_count; row++) {
+            kill_review_row(row);
+        }
+        maybe_compact_reviews();
+        return -1;
+    }
+    if (run->added == 0) {
+        return 0;
+    }
+
+    int *rows = malloc(run->added * sizeof(int));
+    if (!rows) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    for (int i = 0; i < run->added; i++) rows[i] = first_row + i;
+    Review unchanged = {NULL, -1, NULL, NULL};
+    undo_record(UNDO_ADD, rows, run->added, unchanged);
+    free(rows);
+
+    // A log this big would be checkpointed at the next commit anyway, so
+    // the rows go straight into the CSV instead (or into the log after all
+    // if the CSV can't be written)
+    if (wal_fd < 0 || (long long)run->added * WAL_CHECKPOINT_RATIO < review_count ||
+        wal_checkpoint() != 0) {
+        for (int row = first_row; row < review_count; row++) {
+            wal_log_add(row);
         }
-        
-        review_count--;
-        printf("✅ Review deleted!\n");
-        printf("💡 Tip: Use menu option 9 to undo if this was a mistake.\n");
-    } else {
-        printf("❌ Deletion cancelled.\n");
     }
+    return 0;
 }
 
-void undo_last_delete() {
-    if (!has_deleted) {
-        printf("❌ No deletion to undo.\n");
-        return;
+// Lines in a file (or in the chunks of a manifest, checking each one), one
+// more than there can be records. -1 if it can't be read.
+long long count_import_records(const char *filename, int manifest) {
+    long long lines = 1;  // a last record without '\n'
+    if (manifest) {
+        return manifest_read_chunks(filename, 1, count_chunk_lines, &lines) == 0 ? lines : -1;
     }
-    
-    printf("\n♻️  Restoring deleted review:\n");
-    printf("  Name: %s\n", last_deleted_review.reviewer_name);
-    printf("  Score: %d/5\n", last_deleted_review.satisfaction_score);
-    printf("  Date: %s\n", last_deleted_review.review_date);
-    
-    // Check capacity
-    if (review_count >= capacity) {
-        resize_review_array();
+
+    FILE *file = fopen(filename, "r");
+    if (!file) {
+        return -1;
     }
-    
-    // Insert at original position or end if position invalid
-    int insert_pos = last_deleted_position;
-    if (insert_pos < 0 || insert_pos > review_count) {
-        insert_pos = review_count;
+    char *block = malloc(STREAM_BLOCK_SIZE);
+    if (!block) {
+        printf("Memory allocation failed!\n");
+        exit(1);
     }
-    
-    // Shift elements to make room
-    for (int i = review_count; i > insert_pos; i--) {
-        reviews[i] = reviews[i - 1];
+    size_t length;
+    while ((length = fread(block, 1, STREAM_BLOCK_SIZE, file)) > 0) {
+        count_chunk_lines(block, length, &lines);
     }
-    
-    // Restore the review
-    reviews[insert_pos].reviewer_name = last_deleted_review.reviewer_name;
-    reviews[insert_pos].satisfaction_score = last_deleted_review.satisfaction_score;
-    reviews[insert_pos].review_date = last_deleted_review.review_date;
-    reviews[insert_pos].feedback = last_deleted_review.feedback;
-    
-    review_count++;
-    has_deleted = 0;  // Can only undo once
-    
-    printf("✅ Review restored successfully!\n");
+    int failed = ferror(file);  // an empty file is fine, nothing to add
+    free(block);
+    fclose(file);
+    return failed ? -1 : lines;
 }
 
-// statics and display
+// ChunkCallback that adds up the '\n's of a chunk
+void count_chunk_lines(char *text, size_t length, void *context) {
+    long long *lines = context;
+    char *end = text + length;
+    while ((text = memchr(text, '\n', end - text)) != NULL) {
+        (*lines)++;
+        text++;
+    }
+}
 
-void show_statistics() {
-    if (review_count == 0) {
-        printf("\n📊 No data to show statistics.\n");
+// LineCallback of import_reviews(): check one record and add it
+void import_record(char *line, void *context) {
+    ImportRun *run = context;
+    int first = run->first_record;
+    run->first_record = 0;
+    if (line[strspn(line, " \t\r")] == '\0') return;  // blank line
+    if (first && !run->ndjson && strncmp(line, "ReviewerName,", 13) == 0) return;  // CSV header
+
+    char *fields[CSV_FIELDS];
+    int score;
+    int parsed = run->ndjson ? parse_ndjson_review(line, fields) : split_review_line(line, fields);
+    if (!parsed || review_fields_error(fields, &score)) {
+        run->invalid++;
         return;
     }
-    
-    printf("\n╔════════════════════════════════════════╗\n");
-    printf("║           📊 Statistics                ║\n");
-    printf("╚════════════════════════════════════════╝\n");
-    
-    int score_counts[5] = {0};
-    float total = 0;
-    
-    for (int i = 0; i < review_count; i++) {
-        int score = reviews[i].satisfaction_score;
-        if (score >= 1 && score <= 5) {
-            score_counts[score - 1]++;
-            total += score;
-        }
-    }
-    
-    printf("Total Reviews: %d\n", review_count);
-    printf("Average Score: %.2f/5\n\n", total / review_count);
-    
-    printf("Score Distribution:\n");
-    for (int i = 4; i >= 0; i--) {
-        printf("%d ⭐ ", i + 1);
-        int bars = (score_counts[i] * 20) / review_count;
-        for (int j = 0; j < bars; j++) printf("█");
-        printf(" (%d)\n", score_counts[i]);
+    if (run->skip_duplicates && key_set_add(&run->keys, review_count, fields[0], fields[2], fields[3])) {
+        run->duplicates++;
+        return;
     }
+    append_review(allocate_string(fields[0]), score, allocate_string(fields[2]), allocate_string(fields[3]));
+    run->added++;
 }
 
-void display_search_results(int *found_indices, int count, const char *search_term);
-void display_numbered_results(int *indices, int count);
+// NDJSON if the first thing in the file is a '{'
+int is_ndjson_file(const char *filename) {
+    FILE *file = fopen(filename, "r");
+    if (!file) return 0;
+    int c;
+    while ((c = getc(file)) == ' ' || c == '\t' || c == '\r' || c == '\n');
+    fclose(file);
+    return c == '{';
+}
 
-// helper functions
+// One NDJSON record, {"name": ..., "score": ..., "date": ..., "feedback": ...}
+// (the CSV header names work too, other members are skipped), into fields.
+// Strings are unescaped in place, the score can be a number or a string.
+// Returns 0 if the line is not such an object.
+int parse_ndjson_review(char *line, char **fields) {
+    static const char *names[CSV_FIELDS][2] = {
+        {"name", "ReviewerName"}, {"score", "SatisfactionScore"},
+        {"date", "ReviewDate"}, {"feedback", "Feedback"}};
+    for (int i = 0; i < CSV_FIELDS; i++) fields[i] = NULL;
 
-char* allocate_string(const char *str) {
-    if (!str) return NULL; // check if it's an empty pointer
+    char *p = json_skip_space(line);
+    if (*p++ != '{') return 0;
+    p = json_skip_space(p);
+    if (*p == '}') return 0;
+    for (;;) {
+        char *key;
+        if (*p != '"' || !(p = json_read_string(p + 1, &key))) return 0;
+        p = json_skip_space(p);
+        if (*p++ != ':') return 0;
+        p = json_skip_space(p);
+
+        int field = -1;
+        for (int i = 0; i < CSV_FIELDS && field < 0; i++) {
+            if (strcmp(key, names[i][0]) == 0 || strcmp(key, names[i][1]) == 0) field = i;
+        }
+        char *value_end = NULL;  // a number is cut off once the byte after it is read
+        if (field >= 0 && *p == '"') {
+            if (!(p = json_read_string(p + 1, &fields[field]))) return 0;
+        } else if (field >= 0 && (*p == '-' || isdigit((unsigned char)*p))) {
+            fields[field] = p;
+            p += strspn(p, "+-.0123456789eE");
+            value_end = p;
+        } else if (!(p = json_skip_value(p))) {
+            return 0;
+        }
 
-    char *new_str = (char*)malloc(strlen(str) + 1);
-    if (!new_str) {
-        printf("Memory allocation failed for string\n");
-        exit(1); // netter to terminate cleanly than crash mysteriously
+        p = json_skip_space(p);
+        char next = *p++;
+        if (value_end) *value_end = '\0';
+        if (next == '}') break;
+        if (next != ',') return 0;
+        p = json_skip_space(p);
     }
-    strcpy(new_str, str); // not just copies the pointer, but the actual characters to the new_str with malloc pointer
-    return new_str;
+    if (*json_skip_space(p) != '\0') return 0;
+    for (int i = 0; i < CSV_FIELDS; i++) {
+        if (!fields[i]) return 0;
+    }
+    return 1;
 }
 
-void resize_review_array() {
-    capacity *= 2;
-    reviews = (Review*)realloc(reviews, capacity * sizeof(Review));
-    if (!reviews) {
-        printf("Memory reallocation failed!!\n");
-        exit(1);
+char* json_skip_space(char *p) {
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
+    return p;
+}
+
+// Unescape the JSON string starting at p (just past its opening quote) in
+// place, \uXXXX escapes become UTF-8. Returns the byte after the closing
+// quote, NULL if the string is broken.
+char* json_read_string(char *p, char **value) {
+    char *out = p;
+    *value = p;
+    while (*p != '"') {
+        if (*p == '\0') return NULL;
+        if (*p != '\\') {
+            *out++ = *p++;
+            continue;
+        }
+        p++;
+        switch (*p++) {
+            case '"': *out++ = '"'; break;
+            case '\\': *out++ = '\\'; break;
+            case '/': *out++ = '/'; break;
+            case 'b': *out++ = '\b'; break;
+            case 'f': *out++ = '\f'; break;
+            case 'n': *out++ = '\n'; break;
+            case 'r': *out++ = '\r'; break;
+            case 't': *out++ = '\t'; break;
+            case 'u': {
+                uint32_t cp, low;
+                if (!json_hex4(p, &cp)) return NULL;
+                p += 4;
+                if (cp >= 0xD800 && cp < 0xDC00 && p[0] == '\\' && p[1] == 'u' &&
+                    json_hex4(p + 2, &low) && low >= 0xDC00 && low < 0xE000) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    p += 6;
+                }
+                // 6 or 12 escaped bytes never take more than 3 or 4 in UTF-8
+                if (cp < 0x80) {
+                    *out++ = (char)cp;
+                } else if (cp < 0x800) {
+                    *out++ = (char)(0xC0 | (cp >> 6));
+                    *out++ = (char)(0x80 | (cp & 0x3F));
+                } else if (cp < 0x10000) {
+                    *out++ = (char)(0xE0 | (cp >> 12));
+                    *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+                    *out++ = (char)(0x80 | (cp & 0x3F));
+                } else {
+                    *out++ = (char)(0xF0 | (cp >> 18));
+                    *out++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+                    *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+                    *out++ = (char)(0x80 | (cp & 0x3F));
+                }
+                break;
+            }
+            default:
+                return NULL;
+        }
     }
-    printf("Array resized to capacity: %d\n", capacity);
+    *out = '\0';
+    return p + 1;
 }
 
-char* toLowerCase(const char *str) {
-    if (!str) return NULL;
+// The 4 hex digits of a \u escape. Returns 0 if they are not there.
+int json_hex4(const char *p, uint32_t *value) {
+    *value = 0;
+    for (int i = 0; i < 4; i++) {
+        if (!isxdigit((unsigned char)p[i])) return 0;  // stops at the '\0' too
+        int c = tolower((unsigned char)p[i]);
+        *value = *value << 4 | (c <= '9' ? c - '0' : c - 'a' + 10);
+    }
+    return 1;
+}
 
-    char* lower = malloc(strlen(str) +1 );
-    if (!lower) return NULL; // only check malloc result
+// Step over one JSON value of a member we don't use (objects and arrays
+// included). Returns the byte after it, NULL if it is broken.
+char* json_skip_value(char *p) {
+    int depth = 0;
+    do {
+        p = json_skip_space(p);
+        if (*p == '"') {
+            char *text;
+            if (!(p = json_read_string(p + 1, &text))) return NULL;
+        } else if (*p == '{' || *p == '[') {
+            depth++;
+            p++;
+        } else if (*p == '}' || *p == ']') {
+            if (depth == 0) return NULL;
+            depth--;
+            p++;
+        } else if (*p == ',' || *p == ':') {
+            if (depth == 0) return NULL;
+            p++;
+        } else {
+            size_t length = strcspn(p, " \t\r\n,:{}[]\"");
+            if (length == 0) return NULL;
+            p += length;
+        }
+    } while (depth > 0);
+    return p;
+}
 
-    for (int i = 0; str[i]; i++) {
-        lower[i] = tolower(str[i]);
-    }
-    lower[strlen(str)] = '\0';
-    return lower;
+// Hash of a review's (name, date, feedback), never 0
+uint32_t review_key_hash(const char *name, const char *date, const char *feedback) {
+    uint32_t hash = crc32c(0, name, strlen(name) + 1);  // the '\0's keep the fields apart
+    hash = crc32c(hash, date, strlen(date) + 1);
+    hash = crc32c(hash, feedback, strlen(feedback));
+    return hash ? hash : 1;
 }
 
-void trim_whitespace(char *str) {
-    if (!str) return;
-    
-    // Trim leading spaces
-    char *start = str;
-    while (*start && isspace(*start)) start++;
-    
-    // Trim trailing spaces
-    char *end = start + strlen(start) - 1;
-    while (end > start && isspace(*end)) end--;
-    
-    // Copy trimmed string
-    size_t len = end - start + 1;
-    memmove(str, start, len);
-    str[len] = '\0';
+// Room for keys keys at a load of 2/3 at most
+void key_set_init(ReviewKeySet *set, size_t keys) {
+    size_t slots = 16;
+    while (slots < keys + keys / 2) slots *= 2;
+    set->slots = calloc(slots, sizeof(ReviewKeySlot));
+    if (!set->slots) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    set->mask = slots - 1;
 }
 
-int find_review_by_name(const char *name) {
-    for (int i = 0; i < review_count; i++) {
-        if (strcmp(reviews[i].reviewer_name, name) == 0) {
-            return i;
+// Add the key of row unless an equal one is there already. Returns 1 if it was.
+int key_set_add(ReviewKeySet *set, int row, const char *name, const char *date, const char *feedback) {
+    uint32_t hash = review_key_hash(name, date, feedback);
+    size_t slot = hash & set->mask;
+    while (set->slots[slot].hash) {
+        int other = set->slots[slot].row;
+        if (set->slots[slot].hash == hash && strcmp(review_names[other], name) == 0 &&
+            strcmp(review_dates[other], date) == 0 && strcmp(review_feedbacks[other], feedback) == 0) {
+            return 1;
         }
+        slot = (slot + 1) & set->mask;
     }
-    return -1;
+    set->slots[slot].hash = hash;
+    set->slots[slot].row = row;
+    return 0;
 }
 
-int find_partial_matches(const char *search_term, int *found_indices, int max_results);
+void key_set_free(ReviewKeySet *set) {
+    free(set->slots);
+    memset(set, 0, sizeof(ReviewKeySet));
+}
 
-// validation
+// batch mode
+// review_system --exec <script> (- = stdin) runs one command per line
+// instead of the menus and answers each one on stdout:
+//   add <name>,<score>,<date>,<feedback>   one CSV record, quoted as in the file
+//   import <file> | merge <file>           add the rows of a CSV, NDJSON or backup
+//                                          manifest (merge skips duplicates)
+//   query name <name> | similar <name> | date <first> <last>
+//   delete <name>                          every review by that name
+//   stats | save | backup [name] | commit
+// An answer is "ok [value]" or "error <message>". A query answers
+// "ok <count>" followed by that many CSV records. The log is synced every
+// BATCH_COMMIT_COMMANDS commands, at commit and save, and the answers are
+// flushed right after: the ok of a commit means everything before it is
+// on disk. Undo is off, there is nothing to undo from a script.
 
-int is_valid_date(const char *date_str) {
-    if (!date_str || strlen(date_str) != 10) return 0;
-    if (date_str[4] != '-' || date_str[7] != '-') return 0;
-    
-    for (int i = 0; i < 10; i++) {
-        if (i == 4 || i == 7) continue;
-        if (date_str[i] < '0' || date_str[i] > '9') return 0;
-    }
-    
-    int year = (date_str[0]-'0')*1000 + (date_str[1]-'0')*100 + 
-               (date_str[2]-'0')*10 + (date_str[3]-'0');
-    int month = (date_str[5]-'0')*10 + (date_str[6]-'0');
-    int day = (date_str[8]-'0')*10 + (date_str[9]-'0');
-    
-    // Check year is in valid range (BE or CE) - DON'T RETURN YET
-    int valid_year = 0;
-    if (year >= 2400 && year <= 2700) {
-        valid_year = 1; // BE year
-    } else if (year >= 1900 && year <= 2100) {
-        valid_year = 1; // CE year
+int run_batch(const char *script) {
+    FILE *in = strcmp(script, "-") == 0 ? stdin : fopen(script, "r");
+    if (!in) {
+        fprintf(stderr, "Cannot open %s\n", script);
+        return 2;
     }
-    
-    if (!valid_year) return 0;  // Invalid year range
-    
-    // NOW check month and day (this code will actually run now!)
-    if (month < 1 || month > 12) return 0;
-    if (day < 1 || day > 31) return 0;
-    
-    int days_in_month[] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
-    if (day > days_in_month[month - 1]) return 0;
-    
-    return 1;  // All checks passed
-}
 
-int parseScore(const char* score_str) {
-    if (!score_str || strlen(score_str) == 0) {
-        return -1;
+    // Answers keep the real stdout, what the rest of the program prints
+    // (banners, warnings) goes to stderr
+    BatchRun run;
+    memset(&run, 0, sizeof(run));
+    int out_fd = dup(STDOUT_FILENO);
+    run.out = out_fd >= 0 ? fdopen(out_fd, "w") : NULL;
+    if (!run.out) {
+        fprintf(stderr, "Cannot open stdout\n");
+        return 2;
     }
+    fflush(stdout);
+    dup2(STDERR_FILENO, STDOUT_FILENO);
 
-    char *endptr;
-    long score_long = strtol(score_str, &endptr, 10);
+    initialize_system();
+    undo_byte_limit = 0;
+    if (load_reviews_from_csv("reviews.csv") != 0) {
+        printf("Starting with nothing\n");
+    }
+    if (use_wal) {
+        wal_open("reviews.csv");
+    }
 
-    if (*endptr != '\0' || score_long < 1 || score_long > 5) {
-        return -1;
+    char *line = NULL;
+    size_t capacity = 0;
+    while (batch_read_command(in, &line, &capacity) >= 0) {
+        batch_execute(&run, line);
+        if (run.commands >= BATCH_COMMIT_COMMANDS && batch_commit(&run) != 0) run.errors++;
     }
+    free(line);
+    if (in != stdin) fclose(in);
 
-    return (int)score_long;
+    // Without a log nothing is kept unless the CSV is written
+    if (wal_fd < 0 && run.changed) {
+        if (save_reviews_to_csv("reviews.csv") == 0) {
+            save_snapshot("reviews.csv");
+        } else {
+            run.errors++;
+        }
+    }
+    if (batch_commit(&run) != 0) run.errors++;
+    wal_close();
+    free_all_memory();
+    free(run.row_text);
+    fclose(run.out);
+    return run.errors > 0 ? 1 : 0;
 }
 
-// typo matching
+// Next command into *line, without its line break. Returns -1 at the end.
+// An add whose quoted fields hold line breaks goes on over the next lines.
+ssize_t batch_read_command(FILE *in, char **line, size_t *capacity) {
+    ssize_t length = getline(line, capacity, in);
+    if (length < 0) return -1;
 
-int min3(int a, int b, int c) {
-    int min = a;
-    if (b < min) min = b;
-    if (c < min) min = c;
-    return min;
+    if (strncmp(*line, "add ", 4) == 0) {
+        CsvScanState state;
+        memset(&state, 0, sizeof(state));
+        char *more = NULL;
+        size_t more_capacity = 0;
+        ssize_t scanned = 4, more_length;
+        while (!csv_find_record_end(*line + scanned, *line + length, &state) &&
+               (more_length = getline(&more, &more_capacity, in)) >= 0) {
+            if ((size_t)(length + more_length + 1) > *capacity) {
+                *capacity = (length + more_length + 1) * 2;
+                *line = realloc(*line, *capacity);
+                if (!*line) {
+                    printf("Memory reallocation failed!!\n");
+                    exit(1);
+                }
+            }
+            memcpy(*line + length, more, more_length + 1);
+            scanned = length;
+            length += more_length;
+        }
+        free(more);
+    }
+
+    if (length > 0 && (*line)[length - 1] == '\n') (*line)[--length] = '\0';
+    if (length > 0 && (*line)[length - 1] == '\r') (*line)[--length] = '\0';
+    return length;
 }
 
-/**
- * Calculate Levenshtein Distance (Edit Distance) using "Levenshtein distance algorithm"
- * Returns number of edits needed to transform str1 to str2
- * editDistance("kitten", "sitting") = 3
- *   editDistance("john", "jhon") = 2
- *   editDistance("sarah", "sara") = 1
- * use malloc instead of VLA for better memory safety
- */
+void batch_execute(BatchRun *run, char *line) {
+    line += strspn(line, " \t");
+    if (line[0] == '\0' || line[0] == '#') return;  // blank line or comment
 
-int editDistance(const char* str1, const char* str2) {
-    if (!str1 || !str2) return 999;
+    char *args = line + strcspn(line, " \t");
+    if (*args) *args++ = '\0';
+    args += strspn(args, " \t");
+    run->commands++;
 
-    int len1 = strlen(str1);
-    int len2 = strlen(str2);
-    
-    // FIX: Use len1, not len
-    int **dp = (int**)malloc((len1 + 1) * sizeof(int*));
-    if (!dp) {
-        printf("Memory allocation failed in editDistance!\n");
-        return 999;
+    if (strcmp(line, "add") == 0) {
+        batch_add(run, args);
+    } else if (strcmp(line, "import") == 0) {
+        batch_import(run, args, 0);
+    } else if (strcmp(line, "merge") == 0) {
+        batch_import(run, args, 1);
+    } else if (strcmp(line, "query") == 0) {
+        batch_query(run, args);
+    } else if (strcmp(line, "delete") == 0) {
+        batch_delete(run, args);
+    } else if (strcmp(line, "stats") == 0) {
+        batch_stats(run);
+    } else if (strcmp(line, "save") == 0) {
+        batch_save(run);
+    } else if (strcmp(line, "backup") == 0) {
+        batch_backup(run, args);
+    } else if (strcmp(line, "commit") == 0) {
+        // Answered after the sync, and let out with the answers before it
+        if (wal_commit() != 0) {
+            batch_error(run, "cannot sync");
+        } else {
+            fprintf(run->out, "ok\n");
+        }
+        batch_commit(run);
+    } else {
+        batch_error(run, "unknown command");
     }
+}
 
-    for (int i = 0; i <= len1; i++) {
-        dp[i] = (int*)malloc((len2 + 1) * sizeof(int));
-        if (!dp[i]) {
-            for (int j = 0; j < i; j++) {
-                free(dp[j]);
-            }
-            free(dp);
-            printf("Memory allocation failed in editDistance!\n");
-            return 999;  // FIX: Add semicolon and return
-        }
+// Same checks as the Add Review menu
+void batch_add(BatchRun *run, char *args) {
+    char *fields[CSV_FIELDS];
+    if (!split_review_line(args, fields)) {
+        batch_error(run, "expected name,score,date,feedback");
+        return;
     }
-    
-    // Initialize first column
-    for (int i = 0; i <= len1; i++) {
-        dp[i][0] = i;
+    int score;
+    const char *error = review_fields_error(fields, &score);
+    if (error) {
+        batch_error(run, error);
+        return;
     }
+    add_review_row(allocate_string(fields[0]), score,
+                   allocate_string(fields[2]), allocate_string(fields[3]));
+    run->changed = 1;
+    fprintf(run->out, "ok\n");
+}
 
-    // Initialize first row
-    for (int j = 0; j <= len2; j++) {
-        dp[0][j] = j;
+// import_reviews(), answers "ok added=<n> invalid=<n> duplicates=<n>"
+void batch_import(BatchRun *run, char *args, int skip_duplicates) {
+    trim_whitespace(args);
+    ImportRun import;
+    if (import_reviews(args, skip_duplicates, &import) != 0) {
+        batch_error(run, "cannot import file");
+        return;
     }
+    if (import.added > 0) run->changed = 1;
+    fprintf(run->out, "ok added=%d invalid=%d duplicates=%d\n", import.added, import.invalid, import.duplicates);
+}
 
-    // Fill the DP table - FIX: Complete the assignment
-    for (int i = 1; i <= len1; i++) {
-        for (int j = 1; j <= len2; j++) {
-            if (tolower(str1[i-1]) == tolower(str2[j-1])) {
-                dp[i][j] = dp[i-1][j-1];
-            } else {
-                dp[i][j] = 1 + min3(
-                    dp[i-1][j],
-                    dp[i][j-1],
-                    dp[i-1][j-1]
-                );
-            }
+void batch_query(BatchRun *run, char *args) {
+    char *what = args;
+    args += strcspn(args, " \t");
+    if (*args) *args++ = '\0';
+    trim_whitespace(args);
+
+    int *rows = malloc((review_count > 0 ? review_count : 1) * sizeof(int));
+    if (!rows) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    int count = 0;
+    if (strcmp(what, "name") == 0) {
+        int row_count;
+        const int *name_rows = find_rows_by_name(args, &row_count);
+        for (int i = 0; i < row_count; i++) {
+            if (is_review_live(name_rows[i])) rows[count++] = name_rows[i];
+        }
+    } else if (strcmp(what, "similar") == 0) {
+        // Closest names first, like the Search Reviews menu
+        SearchResult *results = searchWithTypoCorrection(args, &count, 3);
+        for (int i = 0; i < count; i++) rows[i] = results[i].index;
+        free(results);
+    } else if (strcmp(what, "date") == 0) {
+        char *last = args + strcspn(args, " \t");
+        if (*last) *last++ = '\0';
+        trim_whitespace(last);
+        int32_t first_key = pack_date(args), last_key = pack_date(last);
+        if (!first_key || !last_key) {
+            free(rows);
+            batch_error(run, "dates must be YYYY-MM-DD");
+            return;
+        }
+        int start;
+        int found = find_reviews_in_date_range(day_number(first_key), day_number(last_key), &start);
+        for (int i = 0; i < found; i++) {
+            if (is_review_live(date_index[start + i].row)) rows[count++] = date_index[start + i].row;
         }
+    } else {
+        free(rows);
+        batch_error(run, "query name, similar or date");
+        return;
     }
+    batch_put_rows(run, rows, count);
+    free(rows);
+}
 
-    int result = dp[len1][len2];
+void batch_delete(BatchRun *run, char *args) {
+    trim_whitespace(args);
+    int deleted = delete_reviews_by_name(args);
+    if (deleted > 0) run->changed = 1;
+    fprintf(run->out, "ok %d\n", deleted);
+}
 
-    for (int i = 0; i <= len1; i++) {
-        free(dp[i]);
+// "ok count=<n> average=<avg> min=<score> max=<score> score1=<n> ... score5=<n>"
+void batch_stats(BatchRun *run) {
+    int live_count = live_review_count();
+    ScoreStats stats;
+    compute_live_score_stats(&stats);
+    fprintf(run->out, "ok count=%d average=%.2f min=%d max=%d", live_count,
+            live_count > 0 ? (double)stats.sum / live_count : 0.0,
+            live_count > 0 ? stats.min_score : 0, live_count > 0 ? stats.max_score : 0);
+    for (int i = 0; i < 5; i++) {
+        fprintf(run->out, " score%d=%d", i + 1, stats.counts[i]);
     }
-    free(dp);
-
-    return result;
+    fprintf(run->out, " out_of_range=%d\n", stats.out_of_range);
 }
 
-// backup/restore
-
-int backup_reviews(const char *backup_name) {
-    char filename[256];
-    time_t now = time(NULL);
-    struct tm *t = localtime(&now);
-    
-    if (backup_name) {
-        snprintf(filename, sizeof(filename), "backup_%s.csv", backup_name);
-    } else {
-        snprintf(filename, sizeof(filename), 
-                 "backup_%04d%02d%02d_%02d%02d%02d.csv",
-                 t->tm_year + 1900, t->tm_mon + 1, t->tm_mday,
-                 t->tm_hour, t->tm_min, t->tm_sec);
+void batch_save(BatchRun *run) {
+    int saved;
+    if (wal_fd >= 0) {
+        saved = wal_checkpoint();
+    } else if ((saved = save_reviews_to_csv("reviews.csv")) == 0) {
+        save_snapshot("reviews.csv");
     }
-    
-    if (save_reviews_to_csv(filename) == 0) {
-        printf("✅ Backup created: %s\n", filename);
-        return 0;
+    if (saved != 0) {
+        batch_error(run, "cannot save");
+        return;
     }
-    return -1;
+    run->changed = 0;
+    fprintf(run->out, "ok\n");
+    batch_commit(run);
 }
 
-int restore_from_backup(const char *filename) {
-    printf("⚠️  This will replace current data!\n");
-    printf("Continue? (y/n): ");
-    char confirm;
-    scanf(" %c", &confirm);
-    getchar();
-    
-    if (confirm != 'y' && confirm != 'Y') {
-        printf("Restore cancelled.\n");
-        return -1;
+// Answers "ok <manifest file>"
+void batch_backup(BatchRun *run, char *args) {
+    trim_whitespace(args);
+    char manifest[256];
+    if (backup_reviews(strlen(args) > 0 ? args : NULL, manifest, sizeof(manifest)) != 0) {
+        batch_error(run, "cannot create backup");
+        return;
     }
-    
-    // Free current data
-    free_all_memory();
-    initialize_system();
-    
-    if (load_reviews_from_csv(filename) == 0) {
-        printf("✅ Data restored from: %s\n", filename);
-        return 0;
-    } else {
-        printf("❌ Failed to restore backup!\n");
-        return -1;
+    fprintf(run->out, "ok %s\n", manifest);
+}
+
+// Sync the log, then let the answers out. Returns -1 if the sync failed.
+int batch_commit(BatchRun *run) {
+    int synced = wal_commit();
+    fflush(run->out);
+    run->commands = 0;
+    return synced;
+}
+
+// "ok <count>" and the rows as CSV records
+void batch_put_rows(BatchRun *run, const int *rows, int count) {
+    fprintf(run->out, "ok %d\n", count);
+    for (int i = 0; i < count; i++) {
+        size_t bound = csv_row_bound(rows[i]);
+        if (bound > run->row_capacity) {
+            run->row_capacity = bound * 2;
+            run->row_text = realloc(run->row_text, run->row_capacity);
+            if (!run->row_text) {
+                printf("Memory reallocation failed!!\n");
+                exit(1);
+            }
+        }
+        char *end = csv_put_row(run->row_text, rows[i]);
+        fwrite(run->row_text, 1, end - run->row_text, run->out);
     }
-}
\ No newline at end of file
+}
+
+void batch_error(BatchRun *run, const char *message) {
+    fprintf(run->out, "error %s\n", message);
+    run->errors++;
+}
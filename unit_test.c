@@ -3,6 +3,16 @@
 #include <string.h>
 #include <ctype.h>
 #include <assert.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SCORE_STATS_X86 1
+#else
+#define SCORE_STATS_X86 0
+#endif
 
 // Test counter
 int tests_passed = 0;
@@ -28,72 +38,286 @@ int min3(int a, int b, int c) {
     return min;
 }
 
+_Thread_local uint64_t *myers_peq = NULL;
+_Thread_local uint64_t *myers_pv = NULL;
+_Thread_local uint64_t *myers_mv = NULL;
+_Thread_local int myers_capacity = 0;
+_Thread_local int *partial_rows = NULL;
+_Thread_local int partial_capacity = 0;
+
+int editDistanceWithin(const char* str1, const char* str2, int maxDistance);
+int myers_block(uint64_t *pv, uint64_t *mv, uint64_t eq, int carry_in, uint64_t high_bit);
+int myers_grow_scratch(int blocks);
+void myers_free_scratch();
+
 int editDistance(const char* str1, const char* str2) {
     if (!str1 || !str2) return 999;
+    return editDistanceWithin(str1, str2, (int)(strlen(str1) + strlen(str2)));
+}
 
-    int len1 = strlen(str1);
-    int len2 = strlen(str2);
-    
-    int **dp = (int**)malloc((len1 + 1) * sizeof(int*));
-    if (!dp) {
+int editDistanceWithin(const char* str1, const char* str2, int maxDistance) {
+    if (!str1 || !str2) return 999;
+
+    const char *pattern = str1, *text = str2;
+    int m = strlen(str1);
+    int n = strlen(str2);
+    if (m > n) {
+        pattern = str2;
+        text = str1;
+        int temp = m;
+        m = n;
+        n = temp;
+    }
+
+    if (n - m > maxDistance) return maxDistance + 1;
+    if (m == 0) return n;
+
+    int blocks = (m + 63) / 64;
+    if (blocks > myers_capacity && !myers_grow_scratch(blocks)) {
         printf("Memory allocation failed in editDistance!\n");
         return 999;
     }
 
-    for (int i = 0; i <= len1; i++) {
-        dp[i] = (int*)malloc((len2 + 1) * sizeof(int));
-        if (!dp[i]) {
-            for (int j = 0; j < i; j++) {
-                free(dp[j]);
-            }
-            free(dp);
-            printf("Memory allocation failed in editDistance!\n");
-            return 999;
+    for (int i = 0; i < m; i++) {
+        unsigned char c = tolower((unsigned char)pattern[i]);
+        myers_peq[c * blocks + i / 64] |= 1ULL << (i % 64);
+    }
+    for (int b = 0; b < blocks; b++) {
+        myers_pv[b] = ~0ULL;
+        myers_mv[b] = 0;
+    }
+
+    uint64_t last_row_bit = 1ULL << ((m - 1) % 64);
+    int score = m;
+
+    for (int j = 0; j < n; j++) {
+        const uint64_t *eq = myers_peq + tolower((unsigned char)text[j]) * blocks;
+
+        int carry = 1;
+        for (int b = 0; b < blocks; b++) {
+            uint64_t high_bit = (b == blocks - 1) ? last_row_bit : (1ULL << 63);
+            carry = myers_block(&myers_pv[b], &myers_mv[b], eq[b], carry, high_bit);
+        }
+        score += carry;
+
+        if (score - (n - j - 1) > maxDistance) {
+            score = maxDistance + 1;
+            break;
         }
     }
-    
-    for (int i = 0; i <= len1; i++) {
-        dp[i][0] = i;
+
+    for (int i = 0; i < m; i++) {
+        unsigned char c = tolower((unsigned char)pattern[i]);
+        myers_peq[c * blocks + i / 64] = 0;
     }
 
-    for (int j = 0; j <= len2; j++) {
-        dp[0][j] = j;
+    return score;
+}
+
+int myers_block(uint64_t *pv, uint64_t *mv, uint64_t eq, int carry_in, uint64_t high_bit) {
+    uint64_t Pv = *pv;
+    uint64_t Mv = *mv;
+    uint64_t Xv = eq | Mv;
+    if (carry_in < 0) eq |= 1;
+    uint64_t Xh = (((eq & Pv) + Pv) ^ Pv) | eq;
+    uint64_t Ph = Mv | ~(Xh | Pv);
+    uint64_t Mh = Pv & Xh;
+
+    int carry_out = 0;
+    if (Ph & high_bit) carry_out = 1;
+    else if (Mh & high_bit) carry_out = -1;
+
+    Ph <<= 1;
+    Mh <<= 1;
+    if (carry_in < 0) Mh |= 1;
+    else if (carry_in > 0) Ph |= 1;
+
+    *pv = Mh | ~(Xv | Ph);
+    *mv = Ph & Xv;
+    return carry_out;
+}
+
+int myers_grow_scratch(int blocks) {
+    myers_free_scratch();
+    myers_peq = calloc((size_t)256 * blocks, sizeof(uint64_t));
+    myers_pv = malloc(blocks * sizeof(uint64_t));
+    myers_mv = malloc(blocks * sizeof(uint64_t));
+    if (!myers_peq || !myers_pv || !myers_mv) {
+        myers_free_scratch();
+        return 0;
     }
+    myers_capacity = blocks;
+    return 1;
+}
 
-    for (int i = 1; i <= len1; i++) {
-        for (int j = 1; j <= len2; j++) {
-            if (tolower(str1[i-1]) == tolower(str2[j-1])) {
-                dp[i][j] = dp[i-1][j-1];
-            } else {
-                dp[i][j] = 1 + min3(
-                    dp[i-1][j],
-                    dp[i][j-1],
-                    dp[i-1][j-1]
-                );
+void myers_free_scratch() {
+    free(myers_peq);
+    free(myers_pv);
+    free(myers_mv);
+    myers_peq = myers_pv = myers_mv = NULL;
+    myers_capacity = 0;
+    free(partial_rows);
+    partial_rows = NULL;
+    partial_capacity = 0;
+}
+
+int partialDistanceWithin(const char* pattern, const char* text, int maxDistance) {
+    if (!pattern || !text) return 999;
+
+    int m = strlen(pattern);
+    int n = strlen(text);
+    if (m == 0) return 0;
+
+    if (m + 1 > partial_capacity) {
+        int *rows = realloc(partial_rows, 3 * (m + 1) * sizeof(int));
+        if (!rows) {
+            printf("Memory allocation failed in editDistance!\n");
+            return 999;
+        }
+        partial_rows = rows;
+        partial_capacity = m + 1;
+    }
+    // Column j of the table, j-1 and j-2 (for transpositions)
+    int *before = partial_rows;
+    int *prev = partial_rows + (m + 1);
+    int *curr = partial_rows + 2 * (m + 1);
+
+    for (int i = 0; i <= m; i++) prev[i] = i;
+    int best = prev[m];
+
+    for (int j = 1; j <= n && best > 0; j++) {
+        char tc = tolower((unsigned char)text[j - 1]);
+        curr[0] = 0;  // a match may start at any column
+        for (int i = 1; i <= m; i++) {
+            char pc = tolower((unsigned char)pattern[i - 1]);
+            int cost = (pc == tc) ? 0 : 1;
+            curr[i] = min3(prev[i] + 1, curr[i - 1] + 1, prev[i - 1] + cost);
+            if (i > 1 && j > 1 && pc == tolower((unsigned char)text[j - 2])
+                && tolower((unsigned char)pattern[i - 2]) == tc
+                && before[i - 2] + 1 < curr[i]) {
+                curr[i] = before[i - 2] + 1;
             }
         }
+        if (curr[m] < best) best = curr[m];
+
+        int *spare = before;
+        before = prev;
+        prev = curr;
+        curr = spare;
     }
 
-    int result = dp[len1][len2];
+    return best <= maxDistance ? best : maxDistance + 1;
+}
+
+typedef struct {
+    uint32_t first;
+    uint32_t last;
+    int32_t delta;
+    uint32_t stride;
+} CaseFoldRange;
+
+// Simple case folding for the scripts we see in names, sorted by first.
+// A code point folds to cp + delta when it is in [first, last] and, for
+// stride 2 (alternating upper/lower pairs), an even distance from first.
+// Every mapping keeps the UTF-8 length, so folding never resizes a string.
+// Thai and other caseless scripts are copied through unchanged.
+const CaseFoldRange case_fold_ranges[] = {
+    {0x00C0, 0x00D6, 32, 1},    // Latin-1: À..Ö
+    {0x00D8, 0x00DE, 32, 1},    // Ø..Þ
+    {0x0100, 0x012F, 1, 2},     // Latin Extended-A pairs
+    {0x0132, 0x0137, 1, 2},
+    {0x0139, 0x0148, 1, 2},
+    {0x014A, 0x0177, 1, 2},
+    {0x0178, 0x0178, -121, 1},  // Ÿ -> ÿ
+    {0x0179, 0x017E, 1, 2},
+    {0x0391, 0x03A1, 32, 1},    // Greek capitals
+    {0x03A3, 0x03AB, 32, 1},
+    {0x0400, 0x040F, 80, 1},    // Cyrillic Ѐ..Џ
+    {0x0410, 0x042F, 32, 1},    // Cyrillic А..Я
+    {0x0460, 0x0481, 1, 2},
+    {0x048A, 0x04BF, 1, 2},
+    {0x1E00, 0x1E95, 1, 2},     // Latin Extended Additional (Vietnamese)
+    {0x1EA0, 0x1EFF, 1, 2},
+    {0xFF21, 0xFF3A, 32, 1},    // fullwidth Ａ..Ｚ
+};
 
-    for (int i = 0; i <= len1; i++) {
-        free(dp[i]);
+uint32_t fold_code_point(uint32_t cp) {
+    int count = sizeof(case_fold_ranges) / sizeof(case_fold_ranges[0]);
+    for (int i = 0; i < count && cp >= case_fold_ranges[i].first; i++) {
+        const CaseFoldRange *range = &case_fold_ranges[i];
+        if (cp <= range->last && (cp - range->first) % range->stride == 0) {
+            return cp + range->delta;
+        }
     }
-    free(dp);
+    return cp;
+}
+
+// Case-fold src into dst (same length, dst may be src). ASCII goes 16 bytes
+// at a time where SSE2 is there, multi-byte UTF-8 through the table above.
+// Malformed UTF-8 bytes are copied as they are.
+void fold_case(char *dst, const char *src, size_t length) {
+    const unsigned char *in = (const unsigned char*)src;
+    unsigned char *out = (unsigned char*)dst;
+    size_t i = 0;
 
-    return result;
+    while (i < length) {
+#ifdef __SSE2__
+        if (i + 16 <= length) {
+            __m128i chunk = _mm_loadu_si128((const __m128i*)(in + i));
+            if (_mm_movemask_epi8(chunk) == 0) {
+                // All ASCII: add 0x20 to the bytes in 'A'..'Z'
+                __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(chunk, _mm_set1_epi8('A' - 1)),
+                                              _mm_cmplt_epi8(chunk, _mm_set1_epi8('Z' + 1)));
+                chunk = _mm_or_si128(chunk, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+                _mm_storeu_si128((__m128i*)(out + i), chunk);
+                i += 16;
+                continue;
+            }
+        }
+#endif
+        unsigned char c = in[i];
+        if (c < 0x80) {
+            out[i] = (c >= 'A' && c <= 'Z') ? c + 0x20 : c;
+            i++;
+            continue;
+        }
+
+        // Lead byte gives the sequence length, only 2 and 3 byte forms have folds
+        int seq = (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : 1;
+        int valid = seq > 1 && i + seq <= length;
+        for (int k = 1; valid && k < seq; k++) {
+            if ((in[i + k] & 0xC0) != 0x80) valid = 0;
+        }
+        if (!valid) {
+            out[i] = c;
+            i++;
+            continue;
+        }
+
+        uint32_t cp;
+        if (seq == 2) {
+            cp = fold_code_point(((c & 0x1Fu) << 6) | (in[i + 1] & 0x3Fu));
+            out[i] = 0xC0 | (cp >> 6);
+            out[i + 1] = 0x80 | (cp & 0x3F);
+        } else {
+            cp = fold_code_point(((c & 0x0Fu) << 12) | ((in[i + 1] & 0x3Fu) << 6) | (in[i + 2] & 0x3Fu));
+            out[i] = 0xE0 | (cp >> 12);
+            out[i + 1] = 0x80 | ((cp >> 6) & 0x3F);
+            out[i + 2] = 0x80 | (cp & 0x3F);
+        }
+        i += seq;
+    }
 }
 
+
 char* toLowerCase(const char *str) {
     if (!str) return NULL;
 
-    char* lower = malloc(strlen(str) + 1);
-    if (!lower) return NULL;
+    size_t size = strlen(str) + 1;
+    char* lower = malloc(size);
+    if (!lower) return NULL; // only check malloc result
 
-    for (int i = 0; str[i]; i++) {
-        lower[i] = tolower(str[i]);
-    }
-    lower[strlen(str)] = '\0';
+    fold_case(lower, str, size);
     return lower;
 }
 
@@ -158,16 +382,852 @@ int parseScore(const char* score_str) {
     return (int)score_long;
 }
 
+// String pool used by allocate_string() in main.c
+#define POOL_SLAB_SIZE (1024 * 1024)
+#define POOL_CLASS_SIZE 8
+#define POOL_CLASS_COUNT 32
+
+typedef struct PoolSlab {
+    struct PoolSlab *next;
+    size_t size;
+    size_t used;
+    char data[];
+} PoolSlab;
+
+PoolSlab *pool_slabs = NULL;
+char *pool_free_lists[POOL_CLASS_COUNT];
+char *mapped_csv = NULL;
+size_t mapped_csv_size = 0;
+
+int is_mapped_string(const char *str) {
+    return mapped_csv && str >= mapped_csv && str < mapped_csv + mapped_csv_size;
+}
+
+char* pool_alloc(size_t size) {
+    size_t class_index = (size + POOL_CLASS_SIZE - 1) / POOL_CLASS_SIZE - 1;
+    size_t rounded = (class_index + 1) * POOL_CLASS_SIZE;
+
+    if (class_index < POOL_CLASS_COUNT && pool_free_lists[class_index]) {
+        char *block = pool_free_lists[class_index];
+        pool_free_lists[class_index] = *(char**)block;
+        return block;
+    }
+
+    if (!pool_slabs || pool_slabs->used + rounded > pool_slabs->size) {
+        size_t slab_size = rounded > POOL_SLAB_SIZE ? rounded : POOL_SLAB_SIZE;
+        PoolSlab *slab = malloc(sizeof(PoolSlab) + slab_size);
+        if (!slab) {
+            printf("Memory allocation failed for string\n");
+            exit(1);
+        }
+        slab->size = slab_size;
+        slab->used = 0;
+
+        if (rounded > POOL_SLAB_SIZE && pool_slabs) {
+            slab->used = rounded;
+            slab->next = pool_slabs->next;
+            pool_slabs->next = slab;
+            return slab->data;
+        }
+        slab->next = pool_slabs;
+        pool_slabs = slab;
+    }
+
+    char *block = pool_slabs->data + pool_slabs->used;
+    pool_slabs->used += rounded;
+    return block;
+}
+
+void pool_free_all() {
+    while (pool_slabs) {
+        PoolSlab *next = pool_slabs->next;
+        free(pool_slabs);
+        pool_slabs = next;
+    }
+    memset(pool_free_lists, 0, sizeof(pool_free_lists));
+}
+
 char* allocate_string(const char *str) {
     if (!str) return NULL;
 
-    char *new_str = (char*)malloc(strlen(str) + 1);
-    if (!new_str) {
-        printf("Memory allocation failed for string\n");
+    size_t size = strlen(str) + 1;
+    char *new_str = pool_alloc(size);
+    memcpy(new_str, str, size);
+    return new_str;
+}
+
+void release_string(char *str) {
+    if (!str || is_mapped_string(str)) return;
+
+    size_t class_index = (strlen(str) + 1 + POOL_CLASS_SIZE - 1) / POOL_CLASS_SIZE - 1;
+    if (class_index >= POOL_CLASS_COUNT) return;
+
+    *(char**)str = pool_free_lists[class_index];
+    pool_free_lists[class_index] = str;
+}
+
+typedef struct {
+    int counts[5];
+    int out_of_range;
+    long long sum;
+    long long sum_all;
+    int min_score;
+    int max_score;
+} ScoreStats;
+
+void score_stats_scalar(const uint8_t *scores, int count, ScoreStats *stats);
+#if SCORE_STATS_X86
+void score_stats_sse2(const uint8_t *scores, int count, ScoreStats *stats);
+void score_stats_avx2(const uint8_t *scores, int count, ScoreStats *stats);
+#endif
+
+void compute_score_stats(const uint8_t *scores, int count, ScoreStats *stats) {
+    memset(stats, 0, sizeof(ScoreStats));
+    if (count <= 0) return;
+    stats->min_score = 255;
+
+#if SCORE_STATS_X86
+    if (__builtin_cpu_supports("avx2")) {
+        score_stats_avx2(scores, count, stats);
+        return;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        score_stats_sse2(scores, count, stats);
+        return;
+    }
+#endif
+    score_stats_scalar(scores, count, stats);
+}
+
+void score_stats_scalar(const uint8_t *scores, int count, ScoreStats *stats) {
+    for (int i = 0; i < count; i++) {
+        int score = scores[i];
+        stats->sum_all += score;
+        if (score < stats->min_score) stats->min_score = score;
+        if (score > stats->max_score) stats->max_score = score;
+        if (score >= 1 && score <= 5) {
+            stats->counts[score - 1]++;
+            stats->sum += score;
+        } else {
+            stats->out_of_range++;
+        }
+    }
+}
+
+#if SCORE_STATS_X86
+__attribute__((target("sse2")))
+void score_stats_sse2(const uint8_t *scores, int count, ScoreStats *stats) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i totals[5], sum_all = zero;
+    __m128i min_vec = _mm_set1_epi8((char)0xFF), max_vec = zero;
+    for (int v = 0; v < 5; v++) totals[v] = zero;
+
+    int i = 0;
+    while (i + 16 <= count) {
+        __m128i counters[5];
+        for (int v = 0; v < 5; v++) counters[v] = zero;
+
+        int blocks = 0;
+        for (; blocks < 255 && i + 16 <= count; blocks++, i += 16) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(scores + i));
+            for (int v = 0; v < 5; v++) {
+                counters[v] = _mm_sub_epi8(counters[v], _mm_cmpeq_epi8(x, _mm_set1_epi8((char)(v + 1))));
+            }
+            sum_all = _mm_add_epi64(sum_all, _mm_sad_epu8(x, zero));
+            min_vec = _mm_min_epu8(min_vec, x);
+            max_vec = _mm_max_epu8(max_vec, x);
+        }
+        for (int v = 0; v < 5; v++) {
+            totals[v] = _mm_add_epi64(totals[v], _mm_sad_epu8(counters[v], zero));
+        }
+    }
+
+    uint64_t lanes[2];
+    for (int v = 0; v < 5; v++) {
+        _mm_storeu_si128((__m128i*)lanes, totals[v]);
+        stats->counts[v] += (int)(lanes[0] + lanes[1]);
+    }
+    _mm_storeu_si128((__m128i*)lanes, sum_all);
+    stats->sum_all += lanes[0] + lanes[1];
+
+    uint8_t bytes[16];
+    _mm_storeu_si128((__m128i*)bytes, min_vec);
+    for (int b = 0; b < 16; b++) if (bytes[b] < stats->min_score) stats->min_score = bytes[b];
+    _mm_storeu_si128((__m128i*)bytes, max_vec);
+    for (int b = 0; b < 16; b++) if (bytes[b] > stats->max_score) stats->max_score = bytes[b];
+
+    int in_range = 0;
+    for (int v = 0; v < 5; v++) {
+        in_range += stats->counts[v];
+        stats->sum += (long long)stats->counts[v] * (v + 1);
+    }
+    stats->out_of_range = i - in_range;
+
+    score_stats_scalar(scores + i, count - i, stats);
+}
+
+__attribute__((target("avx2")))
+void score_stats_avx2(const uint8_t *scores, int count, ScoreStats *stats) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i totals[5], sum_all = zero;
+    __m256i min_vec = _mm256_set1_epi8((char)0xFF), max_vec = zero;
+    for (int v = 0; v < 5; v++) totals[v] = zero;
+
+    int i = 0;
+    while (i + 32 <= count) {
+        __m256i counters[5];
+        for (int v = 0; v < 5; v++) counters[v] = zero;
+
+        int blocks = 0;
+        for (; blocks < 255 && i + 32 <= count; blocks++, i += 32) {
+            __m256i x = _mm256_loadu_si256((const __m256i*)(scores + i));
+            for (int v = 0; v < 5; v++) {
+                counters[v] = _mm256_sub_epi8(counters[v], _mm256_cmpeq_epi8(x, _mm256_set1_epi8((char)(v + 1))));
+            }
+            sum_all = _mm256_add_epi64(sum_all, _mm256_sad_epu8(x, zero));
+            min_vec = _mm256_min_epu8(min_vec, x);
+            max_vec = _mm256_max_epu8(max_vec, x);
+        }
+        for (int v = 0; v < 5; v++) {
+            totals[v] = _mm256_add_epi64(totals[v], _mm256_sad_epu8(counters[v], zero));
+        }
+    }
+
+    uint64_t lanes[4];
+    for (int v = 0; v < 5; v++) {
+        _mm256_storeu_si256((__m256i*)lanes, totals[v]);
+        stats->counts[v] += (int)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+    }
+    _mm256_storeu_si256((__m256i*)lanes, sum_all);
+    stats->sum_all += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+    uint8_t bytes[32];
+    _mm256_storeu_si256((__m256i*)bytes, min_vec);
+    for (int b = 0; b < 32; b++) if (bytes[b] < stats->min_score) stats->min_score = bytes[b];
+    _mm256_storeu_si256((__m256i*)bytes, max_vec);
+    for (int b = 0; b < 32; b++) if (bytes[b] > stats->max_score) stats->max_score = bytes[b];
+
+    int in_range = 0;
+    for (int v = 0; v < 5; v++) {
+        in_range += stats->counts[v];
+        stats->sum += (long long)stats->counts[v] * (v + 1);
+    }
+    stats->out_of_range = i - in_range;
+
+    score_stats_scalar(scores + i, count - i, stats);
+}
+#endif
+
+uint32_t crc32c_table(uint32_t crc, const void *data, size_t length);
+#if defined(__x86_64__)
+uint32_t crc32c_sse42(uint32_t crc, const void *data, size_t length);
+#endif
+
+// CRC32C (Castagnoli), chained: pass the previous result to continue a CRC.
+// Uses the SSE4.2 crc32 instruction when the CPU has it, 8 bytes at a time.
+uint32_t crc32c(uint32_t crc, const void *data, size_t length) {
+#if defined(__x86_64__)
+    if (__builtin_cpu_supports("sse4.2")) {
+        return crc32c_sse42(crc, data, length);
+    }
+#endif
+    return crc32c_table(crc, data, length);
+}
+
+uint32_t crc32c_table(uint32_t crc, const void *data, size_t length) {
+    static uint32_t table[256];
+    static int table_ready = 0;
+    if (!table_ready) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; bit++) {
+                value = (value >> 1) ^ (0x82F63B78u & -(value & 1));
+            }
+            table[i] = value;
+        }
+        table_ready = 1;
+    }
+
+    const unsigned char *bytes = data;
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2")))
+uint32_t crc32c_sse42(uint32_t crc, const void *data, size_t length) {
+    const unsigned char *bytes = data;
+    uint64_t value = ~crc;
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, bytes, 8);
+        value = _mm_crc32_u64(value, word);
+        bytes += 8;
+        length -= 8;
+    }
+    uint32_t tail = (uint32_t)value;
+    while (length-- > 0) {
+        tail = _mm_crc32_u8(tail, *bytes++);
+    }
+    return ~tail;
+}
+#endif
+
+#define LZ_HASH_BITS 13
+#define LZ_MIN_MATCH 4
+
+size_t lz_sequence(unsigned char *dst, size_t out, const unsigned char *literals, size_t literal_count,
+                   size_t offset, size_t match);
+
+// Built-in LZ codec, LZ4 style: a run of sequences, each
+//   token (literal count << 4 | match length - 4), more literal count,
+//   the literals, match offset (2 bytes), more match length
+// where a count of 15 in the token goes on in the next bytes (255 = add
+// and keep going). The last sequence has literals only. Matches are found
+// through a hash of the next 4 bytes, one candidate per hash.
+size_t lz_compress(const unsigned char *src, size_t length, unsigned char *dst) {
+    int32_t table[1 << LZ_HASH_BITS];
+    memset(table, 0xff, sizeof(table));
+
+    size_t in = 0, anchor = 0, out = 0;
+    while (in + LZ_MIN_MATCH <= length) {
+        uint32_t sequence, candidate_sequence;
+        memcpy(&sequence, src + in, 4);
+        uint32_t hash = (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+        int32_t candidate = table[hash];
+        table[hash] = (int32_t)in;
+        if (candidate < 0 || in - candidate > 65535 ||
+            (memcpy(&candidate_sequence, src + candidate, 4), candidate_sequence != sequence)) {
+            in++;
+            continue;
+        }
+
+        size_t match = LZ_MIN_MATCH;
+        while (in + match < length && src[candidate + match] == src[in + match]) match++;
+        out = lz_sequence(dst, out, src + anchor, in - anchor, in - candidate, match);
+        in += match;
+        anchor = in;
+    }
+    return lz_sequence(dst, out, src + anchor, length - anchor, 0, 0);
+}
+
+// Write one sequence (match = 0: literals only), returns the new end of dst
+size_t lz_sequence(unsigned char *dst, size_t out, const unsigned char *literals, size_t literal_count,
+                   size_t offset, size_t match) {
+    size_t extra = match ? match - LZ_MIN_MATCH : 0;
+    dst[out++] = (unsigned char)((literal_count < 15 ? literal_count : 15) << 4 | (extra < 15 ? extra : 15));
+    if (literal_count >= 15) {
+        size_t rest = literal_count - 15;
+        for (; rest >= 255; rest -= 255) dst[out++] = 255;
+        dst[out++] = (unsigned char)rest;
+    }
+    memcpy(dst + out, literals, literal_count);
+    out += literal_count;
+    if (match) {
+        dst[out++] = offset & 0xFF;
+        dst[out++] = offset >> 8;
+        if (extra >= 15) {
+            size_t rest = extra - 15;
+            for (; rest >= 255; rest -= 255) dst[out++] = 255;
+            dst[out++] = (unsigned char)rest;
+        }
+    }
+    return out;
+}
+
+// Unpack lz_compress() output into exactly length bytes, checking every
+// count and offset against both buffers. Returns 0 on success.
+int lz_decompress(const unsigned char *src, size_t packed, unsigned char *dst, size_t length) {
+    size_t in = 0, out = 0;
+    while (in < packed) {
+        unsigned char token = src[in++];
+        size_t literal_count = token >> 4;
+        if (literal_count == 15) {
+            unsigned char more;
+            do {
+                if (in >= packed) return -1;
+                more = src[in++];
+                literal_count += more;
+            } while (more == 255);
+        }
+        if (literal_count > packed - in || literal_count > length - out) return -1;
+        memcpy(dst + out, src + in, literal_count);
+        in += literal_count;
+        out += literal_count;
+        if (in == packed) break;  // last sequence
+
+        if (packed - in < 2) return -1;
+        size_t offset = src[in] | (size_t)src[in + 1] << 8;
+        in += 2;
+        size_t match = (token & 15) + LZ_MIN_MATCH;
+        if ((token & 15) == 15) {
+            unsigned char more;
+            do {
+                if (in >= packed) return -1;
+                more = src[in++];
+                match += more;
+            } while (more == 255);
+        }
+        if (offset == 0 || offset > out || match > length - out) return -1;
+        for (size_t i = 0; i < match; i++, out++) {
+            dst[out] = dst[out - offset];  // may overlap, byte by byte
+        }
+    }
+    return out == length ? 0 : -1;
+}
+
+// The CSV scanner uses SSE2, which every x86-64 CPU has
+#if defined(__SSE2__)
+#define CSV_SCAN_SSE2 1
+#else
+#define CSV_SCAN_SSE2 0
+#endif
+
+#define CSV_FIELDS 4  // name, score, date, feedback (the last one takes the rest of the record)
+#define CSV_BLOCK 64  // bytes per csv_block_bits() scan
+
+// Where csv_find_record_end() stopped, all 0 at the start of a record
+typedef struct {
+    int in_quotes;        // inside a quoted part of a field
+    int quote_is_text;    // a '"' at the next byte is plain text, not an opening quote
+    int field;            // fields started so far after the first
+} CsvScanState;
+
+// Reader that cuts the records of a writable buffer in place (see csv_read_record)
+typedef struct {
+    char *next;           // start of the next record
+    char *end;            // end of the buffer, *end must be writable too
+    char *block;          // the 64 bytes the bits are for, NULL = none yet
+    uint64_t bits;        // ',', '"' and '\n' in block
+    int unclosed;         // the last record ran into the end inside quotes
+} CsvReader;
+
+void csv_cut_field(char *out, char *segment, char *stop);
+
+// Bits of the ',', '"' and '\n' among the 64 bytes at p (available says how
+// many are there, the rest counts as plain text)
+uint64_t csv_block_bits(const char *p, size_t available) {
+    char padded[CSV_BLOCK];
+    if (available < CSV_BLOCK) {
+        memset(padded, 0, sizeof(padded));
+        memcpy(padded, p, available);
+        p = padded;
+    }
+
+    uint64_t bits = 0;
+#if CSV_SCAN_SSE2
+    const __m128i comma = _mm_set1_epi8(','), quote = _mm_set1_epi8('"'), newline = _mm_set1_epi8('\n');
+    for (int i = 0; i < CSV_BLOCK / 16; i++) {
+        __m128i bytes = _mm_loadu_si128((const __m128i*)(p + 16 * i));
+        __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, comma), _mm_cmpeq_epi8(bytes, quote)),
+                                    _mm_cmpeq_epi8(bytes, newline));
+        bits |= (uint64_t)(uint16_t)_mm_movemask_epi8(hits) << (16 * i);
+    }
+#else
+    for (int i = 0; i < CSV_BLOCK; i++) {
+        if (p[i] == ',' || p[i] == '"' || p[i] == '\n') bits |= 1ULL << i;
+    }
+#endif
+    return bits;
+}
+
+void csv_reader_init(CsvReader *reader, char *begin, char *end) {
+    reader->next = begin;
+    reader->end = end;
+    reader->block = NULL;
+    reader->bits = 0;
+    reader->unclosed = 0;
+}
+
+// Next ',', '"' or '\n' at or after from, reader->end if there is none
+char* csv_next_structural(CsvReader *reader, char *from) {
+    while (from < reader->end) {
+        if (!reader->block || from < reader->block || from >= reader->block + CSV_BLOCK) {
+            reader->block = from;
+            reader->bits = csv_block_bits(from, reader->end - from);
+        }
+        uint64_t bits = reader->bits & (~0ULL << (from - reader->block));
+        if (bits) {
+            return reader->block + __builtin_ctzll(bits);
+        }
+        from = reader->block + CSV_BLOCK;
+    }
+    return reader->end;
+}
+
+/**
+ * Cut the next record into fields in place: every field gets a '\0' and
+ * quoted parts lose their quotes (the text moves left over them, so it only
+ * writes behind the scan). After max_fields - 1 commas the last field takes
+ * the rest of the record. Returns the number of fields (1 for an empty
+ * line), 0 at the end of the buffer.
+ */
+int csv_read_record(CsvReader *reader, char **fields, int max_fields) {
+    char *at = reader->next;
+    if (at >= reader->end) {
+        return 0;
+    }
+
+    int count = 1;
+    fields[0] = at;
+    char *segment = at;   // text of the field not moved yet
+    char *out = NULL;     // where that text goes, NULL = the field stays in place
+    char *opens = at;     // a '"' here opens a quoted part
+    int in_quotes = 0;
+    for (;; at++) {
+        at = csv_next_structural(reader, at);
+        if (at >= reader->end) break;
+
+        if (in_quotes) {
+            if (*at == '"') {
+                memmove(out, segment, at - segment);
+                out += at - segment;
+                segment = opens = at + 1;  // a '"' right after is a doubled one
+                in_quotes = 0;
+            }
+        } else if (*at == '"') {
+            if (at == opens) {
+                if (out) {
+                    memmove(out, segment, at - segment);
+                    out += at - segment;
+                    *out++ = '"';
+                } else {
+                    out = at;
+                }
+                segment = at + 1;
+                in_quotes = 1;
+            }
+        } else if (*at == ',') {
+            if (count < max_fields) {
+                csv_cut_field(out, segment, at);
+                fields[count++] = segment = opens = at + 1;
+                out = NULL;
+            }
+        } else {
+            break;  // '\n'
+        }
+    }
+
+    reader->unclosed = in_quotes;
+    reader->next = at < reader->end ? at + 1 : reader->end;
+    char *stop = at;
+    if (!in_quotes && stop > segment && stop[-1] == '\r') stop--;
+    csv_cut_field(out, segment, stop);
+    return count;
+}
+
+// End a field at stop: the text from segment on goes to out and gets its
+// '\0' (out = NULL: the field was never quoted and is already in place)
+void csv_cut_field(char *out, char *segment, char *stop) {
+    if (out) {
+        memmove(out, segment, stop - segment);
+        out[stop - segment] = '\0';
+    } else {
+        *stop = '\0';
+    }
+}
+
+// The '\n' that ends the record a scan is in, NULL if the buffer ends first.
+// Reads only, state carries what the scan knows on to the next buffer.
+char* csv_find_record_end(char *p, char *end, CsvScanState *state) {
+    char *opens = state->quote_is_text ? NULL : p;
+    for (; p < end; p += CSV_BLOCK) {
+        uint64_t bits = csv_block_bits(p, end - p);
+        while (bits) {
+            char *at = p + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            if (state->in_quotes) {
+                if (*at == '"') {
+                    state->in_quotes = 0;
+                    opens = at + 1;
+                }
+            } else if (*at == '"') {
+                if (at == opens) state->in_quotes = 1;
+            } else if (*at == ',') {
+                if (state->field < CSV_FIELDS - 1) {
+                    state->field++;
+                    opens = at + 1;
+                }
+            } else {
+                memset(state, 0, sizeof(CsvScanState));
+                return at;
+            }
+        }
+    }
+    state->quote_is_text = opens != end;
+    return NULL;
+}
+
+// Fields holding ',', '"' or a line break are written quoted, with their
+// quotes doubled
+char* csv_put_field(char *dst, const char *field) {
+    size_t plain = strcspn(field, ",\"\r\n");
+    if (field[plain] == '\0') {
+        memcpy(dst, field, plain);
+        return dst + plain;
+    }
+    *dst++ = '"';
+    for (; *field; field++) {
+        if (*field == '"') *dst++ = '"';
+        *dst++ = *field;
+    }
+    *dst++ = '"';
+    return dst;
+}
+
+// Next command into *line, without its line break. Returns -1 at the end.
+// An add whose quoted fields hold line breaks goes on over the next lines.
+ssize_t batch_read_command(FILE *in, char **line, size_t *capacity) {
+    ssize_t length = getline(line, capacity, in);
+    if (length < 0) return -1;
+
+    if (strncmp(*line, "add ", 4) == 0) {
+        CsvScanState state;
+        memset(&state, 0, sizeof(state));
+        char *more = NULL;
+        size_t more_capacity = 0;
+        ssize_t scanned = 4, more_length;
+        while (!csv_find_record_end(*line + scanned, *line + length, &state) &&
+               (more_length = getline(&more, &more_capacity, in)) >= 0) {
+            if ((size_t)(length + more_length + 1) > *capacity) {
+                *capacity = (length + more_length + 1) * 2;
+                *line = realloc(*line, *capacity);
+                if (!*line) {
+                    printf("Memory reallocation failed!!\n");
+                    exit(1);
+                }
+            }
+            memcpy(*line + length, more, more_length + 1);
+            scanned = length;
+            length += more_length;
+        }
+        free(more);
+    }
+
+    if (length > 0 && (*line)[length - 1] == '\n') (*line)[--length] = '\0';
+    if (length > 0 && (*line)[length - 1] == '\r') (*line)[--length] = '\0';
+    return length;
+}
+
+char* json_skip_space(char *p);
+char* json_read_string(char *p, char **value);
+int json_hex4(const char *p, uint32_t *value);
+char* json_skip_value(char *p);
+
+// One NDJSON record, {"name": ..., "score": ..., "date": ..., "feedback": ...}
+// (the CSV header names work too, other members are skipped), into fields.
+// Strings are unescaped in place, the score can be a number or a string.
+// Returns 0 if the line is not such an object.
+int parse_ndjson_review(char *line, char **fields) {
+    static const char *names[CSV_FIELDS][2] = {
+        {"name", "ReviewerName"}, {"score", "SatisfactionScore"},
+        {"date", "ReviewDate"}, {"feedback", "Feedback"}};
+    for (int i = 0; i < CSV_FIELDS; i++) fields[i] = NULL;
+
+    char *p = json_skip_space(line);
+    if (*p++ != '{') return 0;
+    p = json_skip_space(p);
+    if (*p == '}') return 0;
+    for (;;) {
+        char *key;
+        if (*p != '"' || !(p = json_read_string(p + 1, &key))) return 0;
+        p = json_skip_space(p);
+        if (*p++ != ':') return 0;
+        p = json_skip_space(p);
+
+        int field = -1;
+        for (int i = 0; i < CSV_FIELDS && field < 0; i++) {
+            if (strcmp(key, names[i][0]) == 0 || strcmp(key, names[i][1]) == 0) field = i;
+        }
+        char *value_end = NULL;  // a number is cut off once the byte after it is read
+        if (field >= 0 && *p == '"') {
+            if (!(p = json_read_string(p + 1, &fields[field]))) return 0;
+        } else if (field >= 0 && (*p == '-' || isdigit((unsigned char)*p))) {
+            fields[field] = p;
+            p += strspn(p, "+-.0123456789eE");
+            value_end = p;
+        } else if (!(p = json_skip_value(p))) {
+            return 0;
+        }
+
+        p = json_skip_space(p);
+        char next = *p++;
+        if (value_end) *value_end = '\0';
+        if (next == '}') break;
+        if (next != ',') return 0;
+        p = json_skip_space(p);
+    }
+    if (*json_skip_space(p) != '\0') return 0;
+    for (int i = 0; i < CSV_FIELDS; i++) {
+        if (!fields[i]) return 0;
+    }
+    return 1;
+}
+
+char* json_skip_space(char *p) {
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
+    return p;
+}
+
+// Unescape the JSON string starting at p (just past its opening quote) in
+// place, \uXXXX escapes become UTF-8. Returns the byte after the closing
+// quote, NULL if the string is broken.
+char* json_read_string(char *p, char **value) {
+    char *out = p;
+    *value = p;
+    while (*p != '"') {
+        if (*p == '\0') return NULL;
+        if (*p != '\\') {
+            *out++ = *p++;
+            continue;
+        }
+        p++;
+        switch (*p++) {
+            case '"': *out++ = '"'; break;
+            case '\\': *out++ = '\\'; break;
+            case '/': *out++ = '/'; break;
+            case 'b': *out++ = '\b'; break;
+            case 'f': *out++ = '\f'; break;
+            case 'n': *out++ = '\n'; break;
+            case 'r': *out++ = '\r'; break;
+            case 't': *out++ = '\t'; break;
+            case 'u': {
+                uint32_t cp, low;
+                if (!json_hex4(p, &cp)) return NULL;
+                p += 4;
+                if (cp >= 0xD800 && cp < 0xDC00 && p[0] == '\\' && p[1] == 'u' &&
+                    json_hex4(p + 2, &low) && low >= 0xDC00 && low < 0xE000) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    p += 6;
+                }
+                // 6 or 12 escaped bytes never take more than 3 or 4 in UTF-8
+                if (cp < 0x80) {
+                    *out++ = (char)cp;
+                } else if (cp < 0x800) {
+                    *out++ = (char)(0xC0 | (cp >> 6));
+                    *out++ = (char)(0x80 | (cp & 0x3F));
+                } else if (cp < 0x10000) {
+                    *out++ = (char)(0xE0 | (cp >> 12));
+                    *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+                    *out++ = (char)(0x80 | (cp & 0x3F));
+                } else {
+                    *out++ = (char)(0xF0 | (cp >> 18));
+                    *out++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+                    *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+                    *out++ = (char)(0x80 | (cp & 0x3F));
+                }
+                break;
+            }
+            default:
+                return NULL;
+        }
+    }
+    *out = '\0';
+    return p + 1;
+}
+
+// The 4 hex digits of a \u escape. Returns 0 if they are not there.
+int json_hex4(const char *p, uint32_t *value) {
+    *value = 0;
+    for (int i = 0; i < 4; i++) {
+        if (!isxdigit((unsigned char)p[i])) return 0;  // stops at the '\0' too
+        int c = tolower((unsigned char)p[i]);
+        *value = *value << 4 | (c <= '9' ? c - '0' : c - 'a' + 10);
+    }
+    return 1;
+}
+
+// Step over one JSON value of a member we don't use (objects and arrays
+// included). Returns the byte after it, NULL if it is broken.
+char* json_skip_value(char *p) {
+    int depth = 0;
+    do {
+        p = json_skip_space(p);
+        if (*p == '"') {
+            char *text;
+            if (!(p = json_read_string(p + 1, &text))) return NULL;
+        } else if (*p == '{' || *p == '[') {
+            depth++;
+            p++;
+        } else if (*p == '}' || *p == ']') {
+            if (depth == 0) return NULL;
+            depth--;
+            p++;
+        } else if (*p == ',' || *p == ':') {
+            if (depth == 0) return NULL;
+            p++;
+        } else {
+            size_t length = strcspn(p, " \t\r\n,:{}[]\"");
+            if (length == 0) return NULL;
+            p += length;
+        }
+    } while (depth > 0);
+    return p;
+}
+
+// Bytes a column of rows rows takes, width bytes per row (0 = one bit)
+size_t column_bytes(size_t rows, size_t width) {
+    return width ? rows * width : (rows + 63) / 64 * sizeof(uint64_t);
+}
+
+// Open up rows [old_rows, rows) of a column in review_store for writing
+void commit_column(void *column, size_t width, int old_rows, int rows) {
+    size_t page = sysconf(_SC_PAGESIZE);
+    uintptr_t from = ((uintptr_t)column + column_bytes(old_rows, width)) / page * page;
+    uintptr_t to = ((uintptr_t)column + column_bytes(rows, width) + page - 1) / page * page;
+    if (to > from && mprotect((void*)from, to - from, PROT_READ | PROT_WRITE) != 0) {
+        printf("Memory reallocation failed!!\n");
         exit(1);
     }
-    strcpy(new_str, str);
-    return new_str;
+}
+
+// Score field of a row being loaded, -1 if the column can't hold it. Such a
+// row is left out (and counted in skipped_rows): storing 0 would write a
+// different score back on the next save.
+int loaded_score(const char *text) {
+    long score = strtol(text, NULL, 10);
+    return score >= 0 && score <= 255 ? (int)score : -1;
+}
+
+// FNV-1a, enough to spot a torn or garbled record
+uint32_t wal_checksum(const char *data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// "2025-08-01" -> 20250801, the era is kept as typed (BE stays BE)
+int32_t pack_date(const char *date_str) {
+    if (!is_valid_date(date_str)) return 0;
+
+    int32_t packed = 0;
+    for (int i = 0; i < 10; i++) {
+        if (i == 4 || i == 7) continue;
+        packed = packed * 10 + (date_str[i] - '0');
+    }
+    return packed;
+}
+
+// Days since 1970-01-01 for a packed YYYYMMDD key (see pack_date)
+int32_t day_number(int32_t packed_date) {
+    int year = packed_date / 10000;
+    int month = packed_date / 100 % 100;
+    int day = packed_date % 100;
+    if (year >= 2400) year -= 543;  // Buddhist Era
+
+    // Count years from March so the leap day is the last day of the year
+    if (month <= 2) year--;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int year_of_era = year - era * 400;
+    int day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    int day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
 }
 
 // ========== TEST FUNCTIONS ==========
@@ -199,6 +1259,41 @@ void test_editDistance() {
     TEST_ASSERT(editDistance("test", NULL) == 999, "NULL pointer should return 999");
 }
 
+void test_editDistanceWithin() {
+    printf("\n=== Testing editDistanceWithin() ===\n");
+
+    TEST_ASSERT(editDistanceWithin("kitten", "sitting", 3) == 3, "Distance equal to the cutoff is exact");
+    TEST_ASSERT(editDistanceWithin("kitten", "sitting", 2) == 3, "Over the cutoff returns cutoff + 1");
+    TEST_ASSERT(editDistanceWithin("ab", "abcdefgh", 3) == 4, "Length difference alone exceeds the cutoff");
+    TEST_ASSERT(editDistanceWithin("Somchai", "somchai", 0) == 0, "Case-insensitive exact match with cutoff 0");
+
+    // Longer than one 64 character block
+    char long1[151], long2[151];
+    for (int i = 0; i < 150; i++) long1[i] = long2[i] = 'a' + (i % 26);
+    long1[150] = long2[150] = '\0';
+    long2[10] = '#';
+    long2[100] = '#';
+    TEST_ASSERT(editDistance(long1, long2) == 2, "150 char strings spanning 3 blocks");
+    TEST_ASSERT(editDistance(long1, long1 + 70) == 70, "Pattern across a block boundary");
+    TEST_ASSERT(editDistanceWithin(long1, long2, 1) == 2, "Cutoff works on multi-block patterns");
+    TEST_ASSERT(editDistance("kitten", "sitting") == 3, "Scratch is clean after a multi-block call");
+
+    myers_free_scratch();
+}
+
+void test_partialDistanceWithin() {
+    printf("\n=== Testing partialDistanceWithin() ===\n");
+
+    TEST_ASSERT(partialDistanceWithin("john", "Michael Johnson", 1) == 0, "Substring match is free of the surrounding text");
+    TEST_ASSERT(partialDistanceWithin("jhon", "John Smith", 1) == 1, "Swapped neighbours count as one edit");
+    TEST_ASSERT(partialDistanceWithin("smtih", "john smith", 2) == 1, "Swap in the middle of the text");
+    TEST_ASSERT(partialDistanceWithin("jhon", "Wilson", 1) == 2, "Over the cutoff returns cutoff + 1");
+    TEST_ASSERT(partialDistanceWithin("", "anything", 0) == 0, "Empty pattern matches");
+    TEST_ASSERT(partialDistanceWithin(NULL, "x", 1) == 999, "NULL pattern returns 999");
+
+    myers_free_scratch();
+}
+
 void test_toLowerCase() {
     printf("\n=== Testing toLowerCase() ===\n");
     
@@ -224,6 +1319,22 @@ void test_toLowerCase() {
     TEST_ASSERT(strcmp(result, "already lowercase") == 0, "Already lowercase unchanged");
     free(result);
     
+    result = toLowerCase("ÉMILE Ÿves");
+    TEST_ASSERT(strcmp(result, "émile ÿves") == 0, "Latin-1 capitals fold to lowercase");
+    free(result);
+
+    result = toLowerCase("ПЁТР สมชาย");
+    TEST_ASSERT(strcmp(result, "пётр สมชาย") == 0, "Cyrillic folds, Thai is unchanged");
+    free(result);
+
+    result = toLowerCase("A LONGER NAME THAT USES THE SIMD PATH É");
+    TEST_ASSERT(strcmp(result, "a longer name that uses the simd path é") == 0, "Long ASCII run then UTF-8 tail");
+    free(result);
+
+    result = toLowerCase("BAD\xc3");
+    TEST_ASSERT(strcmp(result, "bad\xc3") == 0, "Truncated UTF-8 is copied as is");
+    free(result);
+
     result = toLowerCase(NULL);
     TEST_ASSERT(result == NULL, "NULL input should return NULL");
 }
@@ -298,20 +1409,48 @@ void test_allocate_string() {
     char *str1 = allocate_string("Hello");
     TEST_ASSERT(str1 != NULL, "Should allocate memory");
     TEST_ASSERT(strcmp(str1, "Hello") == 0, "Should copy string correctly");
-    free(str1);
+    release_string(str1);
     
     char *str2 = allocate_string("");
     TEST_ASSERT(str2 != NULL, "Should allocate for empty string");
     TEST_ASSERT(strcmp(str2, "") == 0, "Empty string copied correctly");
-    free(str2);
+    release_string(str2);
     
     char *str3 = allocate_string("This is a longer string with spaces!");
     TEST_ASSERT(str3 != NULL, "Should handle long strings");
     TEST_ASSERT(strcmp(str3, "This is a longer string with spaces!") == 0, "Long string copied correctly");
-    free(str3);
+    release_string(str3);
     
     char *str4 = allocate_string(NULL);
     TEST_ASSERT(str4 == NULL, "NULL input should return NULL");
+
+    pool_free_all();
+}
+
+void test_string_pool() {
+    printf("\n=== Testing string pool ===\n");
+
+    char *a = allocate_string("Alice");
+    char *b = allocate_string("Bob");
+    TEST_ASSERT(b - a == 8, "Short strings are packed into 8 byte classes");
+
+    release_string(a);
+    char *c = allocate_string("Carol");
+    TEST_ASSERT(c == a, "Released block is reused for the same size class");
+
+    char *d = allocate_string("A name that needs a bigger class");
+    TEST_ASSERT(d != a && strcmp(d, "A name that needs a bigger class") == 0, "Bigger class is not served from a smaller free list");
+
+    char huge[POOL_SLAB_SIZE + 100];
+    memset(huge, 'x', sizeof(huge) - 1);
+    huge[sizeof(huge) - 1] = '\0';
+    char *e = allocate_string(huge);
+    TEST_ASSERT(strlen(e) == sizeof(huge) - 1, "String bigger than a slab gets its own slab");
+    char *f = allocate_string("Dave");
+    TEST_ASSERT(f - d == 40, "Bump pointer continues in the current slab after a huge string");
+
+    pool_free_all();
+    TEST_ASSERT(pool_slabs == NULL, "pool_free_all() drops every slab");
 }
 
 void test_string_edge_cases() {
@@ -331,6 +1470,274 @@ void test_string_edge_cases() {
     TEST_ASSERT(is_valid_date("2024-04-31") == 0, "April only has 30 days");
 }
 
+void test_compute_score_stats() {
+    printf("\n=== Testing compute_score_stats() ===\n");
+
+    ScoreStats stats;
+    compute_score_stats(NULL, 0, &stats);
+    TEST_ASSERT(stats.sum_all == 0 && stats.min_score == 0 && stats.max_score == 0, "Empty column gives zero stats");
+
+    uint8_t small[] = {5, 4, 3, 2, 5};
+    compute_score_stats(small, 5, &stats);
+    TEST_ASSERT(stats.counts[4] == 2 && stats.counts[1] == 1, "Counts per score on a short column");
+    TEST_ASSERT(stats.sum == 19 && stats.min_score == 2 && stats.max_score == 5, "Sum, min and max on a short column");
+
+    // Long column with some junk scores, longer than one 255 block counter flush
+    int count = 100003;
+    uint8_t *scores = malloc(count);
+    srand(42);
+    for (int i = 0; i < count; i++) {
+        scores[i] = (i % 97 == 0) ? (uint8_t)(rand() % 256) : (uint8_t)(1 + rand() % 5);
+    }
+
+    int expected_counts[5] = {0}, expected_out = 0, expected_min = 255, expected_max = 0;
+    long long expected_sum = 0, expected_sum_all = 0;
+    for (int i = 0; i < count; i++) {
+        expected_sum_all += scores[i];
+        if (scores[i] < expected_min) expected_min = scores[i];
+        if (scores[i] > expected_max) expected_max = scores[i];
+        if (scores[i] >= 1 && scores[i] <= 5) {
+            expected_counts[scores[i] - 1]++;
+            expected_sum += scores[i];
+        } else {
+            expected_out++;
+        }
+    }
+    compute_score_stats(scores, count, &stats);
+
+    TEST_ASSERT(memcmp(stats.counts, expected_counts, sizeof(expected_counts)) == 0, "Counts match a plain loop on 100003 scores");
+    TEST_ASSERT(stats.out_of_range == expected_out, "Out of range count matches");
+    TEST_ASSERT(stats.sum == expected_sum && stats.sum_all == expected_sum_all, "Sums match");
+    TEST_ASSERT(stats.min_score == expected_min && stats.max_score == expected_max, "Min/max include junk scores");
+
+    ScoreStats scalar;
+    memset(&scalar, 0, sizeof(scalar));
+    scalar.min_score = 255;
+    score_stats_scalar(scores + 1, count - 1, &scalar);
+    compute_score_stats(scores + 1, count - 1, &stats);
+    TEST_ASSERT(memcmp(&scalar, &stats, sizeof(ScoreStats)) == 0, "Unaligned start gives the same result as plain C");
+    free(scores);
+}
+
+void test_crc32c() {
+    printf("\n=== Testing crc32c() ===\n");
+
+    TEST_ASSERT(crc32c(0, "", 0) == 0, "Empty input gives 0");
+    TEST_ASSERT(crc32c(0, "123456789", 9) == 0xE3069283u, "Check value of \"123456789\"");
+    TEST_ASSERT(crc32c(crc32c(0, "1234", 4), "56789", 5) == 0xE3069283u, "Chained CRC equals one pass");
+
+    // Odd lengths and offsets, the vector path must agree with the table
+    unsigned char data[1000];
+    for (int i = 0; i < 1000; i++) data[i] = (unsigned char)(i * 31 + 7);
+    int agree = 1;
+    for (int start = 0; start < 9; start++) {
+        for (int length = 0; length < 200; length += 13) {
+            if (crc32c(0, data + start, length) != crc32c_table(0, data + start, length)) agree = 0;
+        }
+    }
+    TEST_ASSERT(agree, "Every offset and length matches the table version");
+}
+
+void test_lz_codec() {
+    printf("\n=== Testing lz_compress() / lz_decompress() ===\n");
+
+    const char *csv = "John Doe,5,2025-08-01,Excellent service and fast delivery\n"
+                      "Jane Smith,4,2025-08-02,Excellent service and fast delivery\n"
+                      "John Doe,5,2025-08-03,Excellent service and fast delivery\n";
+    size_t length = strlen(csv);
+    unsigned char packed[512], unpacked[512];
+    size_t packed_size = lz_compress((const unsigned char*)csv, length, packed);
+    TEST_ASSERT(packed_size < length, "Repeated text gets smaller");
+    TEST_ASSERT(lz_decompress(packed, packed_size, unpacked, length) == 0 &&
+                memcmp(unpacked, csv, length) == 0, "Round trip gives the text back");
+
+    packed_size = lz_compress((const unsigned char*)"", 0, packed);
+    TEST_ASSERT(lz_decompress(packed, packed_size, unpacked, 0) == 0, "Empty input round trips");
+
+    // Long literal runs and long matches use the extra count bytes
+    unsigned char data[4000], big_packed[4100], big_unpacked[4000];
+    for (int i = 0; i < 1000; i++) data[i] = (unsigned char)(i * 7919 % 251);
+    memset(data + 1000, 'a', 3000);
+    packed_size = lz_compress(data, sizeof(data), big_packed);
+    TEST_ASSERT(lz_decompress(big_packed, packed_size, big_unpacked, sizeof(data)) == 0 &&
+                memcmp(big_unpacked, data, sizeof(data)) == 0, "Round trip with long runs");
+    TEST_ASSERT(lz_decompress(big_packed, packed_size / 2, big_unpacked, sizeof(data)) != 0, "Truncated input is rejected");
+    TEST_ASSERT(lz_decompress(big_packed, packed_size, big_unpacked, sizeof(data) - 1) != 0, "Wrong length is rejected");
+}
+
+void test_csv_reader() {
+    printf("\n=== Testing csv_read_record() / csv_find_record_end() ===\n");
+
+    char text[] = "\"Lee, Ann\",5,2025-08-01,\"Said \"\"wow\"\"\nthen left\"\r\n"
+                  "Bob,,2025-08-02,Good, but slow\n"
+                  "Sam,3,2025-08-03,a\"b";
+    size_t length = strlen(text);
+    CsvReader reader;
+    char *fields[CSV_FIELDS];
+    csv_reader_init(&reader, text, text + length);
+
+    int count = csv_read_record(&reader, fields, CSV_FIELDS);
+    TEST_ASSERT(count == 4 && strcmp(fields[0], "Lee, Ann") == 0, "Quoted field keeps its comma");
+    TEST_ASSERT(strcmp(fields[3], "Said \"wow\"\nthen left") == 0, "Doubled quotes and line breaks inside quotes");
+    count = csv_read_record(&reader, fields, CSV_FIELDS);
+    TEST_ASSERT(count == 4 && strcmp(fields[1], "") == 0, "Empty field is kept, not skipped");
+    TEST_ASSERT(strcmp(fields[3], "Good, but slow") == 0, "Last field takes the rest of the record");
+    count = csv_read_record(&reader, fields, CSV_FIELDS);
+    TEST_ASSERT(count == 4 && strcmp(fields[3], "a\"b") == 0 && !reader.unclosed,
+                "Quote inside an unquoted field is text, last record without newline");
+    TEST_ASSERT(csv_read_record(&reader, fields, CSV_FIELDS) == 0, "End of buffer");
+
+    // A record longer than a scan block, cut into two buffers
+    char long_text[300];
+    snprintf(long_text, sizeof(long_text), "Ann,4,2025-08-04,\"%0200d,\n\"\nNext", 0);
+    CsvScanState state;
+    memset(&state, 0, sizeof(state));
+    size_t half = 100;
+    char *end = csv_find_record_end(long_text, long_text + half, &state);
+    TEST_ASSERT(end == NULL && state.in_quotes, "Scan stops inside the quoted field");
+    end = csv_find_record_end(long_text + half, long_text + strlen(long_text), &state);
+    TEST_ASSERT(end != NULL && strcmp(end, "\nNext") == 0, "Record ends at the first newline outside quotes");
+}
+
+void test_csv_put_field() {
+    printf("\n=== Testing csv_put_field() ===\n");
+
+    char out[128];
+    *csv_put_field(out, "Plain text") = '\0';
+    TEST_ASSERT(strcmp(out, "Plain text") == 0, "Plain field is copied as is");
+    *csv_put_field(out, "") = '\0';
+    TEST_ASSERT(strcmp(out, "") == 0, "Empty field stays empty");
+    *csv_put_field(out, "Said \"hi\", then\nleft") = '\0';
+    TEST_ASSERT(strcmp(out, "\"Said \"\"hi\"\", then\nleft\"") == 0, "Quotes doubled, field quoted");
+
+    // What is written reads back the same
+    char record[128];
+    char *end = csv_put_field(record, "a,\"b\"\r\nc");
+    strcpy(end, "\n");
+    CsvReader reader;
+    char *fields[CSV_FIELDS];
+    csv_reader_init(&reader, record, record + strlen(record));
+    TEST_ASSERT(csv_read_record(&reader, fields, CSV_FIELDS) == 1 && strcmp(fields[0], "a,\"b\"\r\nc") == 0,
+                "Written field reads back unchanged");
+}
+
+void test_batch_read_command() {
+    printf("\n=== Testing batch_read_command() ===\n");
+
+    char script[] = "stats\r\n"
+                    "add \"Lee, Ann\",5,2025-08-01,\"two\nlines\"\n"
+                    "query name Bob";
+    FILE *in = fmemopen(script, strlen(script), "r");
+    char *line = NULL;
+    size_t capacity = 0;
+    TEST_ASSERT(batch_read_command(in, &line, &capacity) == 5 && strcmp(line, "stats") == 0,
+                "Line break (CRLF) is cut off");
+    batch_read_command(in, &line, &capacity);
+    TEST_ASSERT(strcmp(line, "add \"Lee, Ann\",5,2025-08-01,\"two\nlines\"") == 0,
+                "Quoted field goes on over the next line");
+    TEST_ASSERT(batch_read_command(in, &line, &capacity) >= 0 && strcmp(line, "query name Bob") == 0,
+                "Last line without a line break");
+    TEST_ASSERT(batch_read_command(in, &line, &capacity) == -1, "End of script");
+    free(line);
+    fclose(in);
+}
+
+void test_parse_ndjson_review() {
+    printf("\n=== Testing parse_ndjson_review() ===\n");
+
+    char *fields[CSV_FIELDS];
+    char line[] = "{\"name\": \"Lee, Ann\", \"extra\": {\"a\": [1, \"}\"]}, \"score\": 5, "
+                  "\"date\": \"2025-08-01\", \"feedback\": \"Said \\\"hi\\\"\\n\\u00e9\\ud83d\\ude00\"}";
+    TEST_ASSERT(parse_ndjson_review(line, fields) == 1, "Object with an unknown nested member");
+    TEST_ASSERT(strcmp(fields[0], "Lee, Ann") == 0 && strcmp(fields[1], "5") == 0 &&
+                strcmp(fields[2], "2025-08-01") == 0, "Strings and a number score");
+    TEST_ASSERT(strcmp(fields[3], "Said \"hi\"\n\xC3\xA9\xF0\x9F\x98\x80") == 0,
+                "Escapes and surrogate pairs unescaped to UTF-8");
+
+    char header_names[] = "{\"ReviewerName\":\"Bo\",\"SatisfactionScore\":\"4\",\"ReviewDate\":\"2568-01-02\",\"Feedback\":\"\"}";
+    TEST_ASSERT(parse_ndjson_review(header_names, fields) == 1 && strcmp(fields[1], "4") == 0,
+                "CSV header names work as keys");
+
+    char missing[] = "{\"name\": \"Bo\", \"score\": 4, \"date\": \"2025-08-01\"}";
+    char broken[] = "{\"name\": \"Bo\", \"score\": 4, \"date\": \"2025-08-01\", \"feedback\": \"x\"";
+    char bad_escape[] = "{\"name\": \"Bo\\u12\", \"score\": 4, \"date\": \"2025-08-01\", \"feedback\": \"x\"}";
+    TEST_ASSERT(!parse_ndjson_review(missing, fields) && !parse_ndjson_review(broken, fields) &&
+                !parse_ndjson_review(bad_escape, fields), "Missing member, no closing brace, bad escape");
+}
+
+void test_wal_checksum() {
+    printf("\n=== Testing wal_checksum() ===\n");
+
+    TEST_ASSERT(wal_checksum("", 0) == 0x811c9dc5u && wal_checksum("a", 1) == 0xe40c292cu,
+                "FNV-1a known values");
+
+    // A record body as wal_log_add() lays it out: type, then name, score,
+    // date and feedback, each string with its length in front
+    char record[64];
+    size_t length = 0;
+    const char *strings[3] = {"Kim", "2024-02-01", "Kept"};
+    record[length++] = 'A';  // WAL_ADD
+    for (int i = 0; i < 3; i++) {
+        uint32_t string_length = strlen(strings[i]);
+        memcpy(record + length, &string_length, 4);
+        memcpy(record + length + 4, strings[i], string_length + 1);
+        length += 4 + string_length + 1;
+        if (i == 0) record[length++] = 5;  // score
+    }
+    uint32_t checksum = wal_checksum(record, length);
+    record[9] = 4;
+    TEST_ASSERT(wal_checksum(record, length) != checksum, "Changed score byte is caught");
+    record[9] = 5;
+    TEST_ASSERT(wal_checksum(record, length) == checksum && wal_checksum(record, length - 1) != checksum,
+                "Torn record is caught");
+}
+
+void test_loaded_score() {
+    printf("\n=== Testing loaded_score() ===\n");
+
+    TEST_ASSERT(loaded_score("5") == 5 && loaded_score("0") == 0 && loaded_score("255") == 255,
+                "Scores the column can hold");
+    TEST_ASSERT(loaded_score("") == 0, "Empty score loads as 0, as before");
+    TEST_ASSERT(loaded_score("256") == -1 && loaded_score("-1") == -1 &&
+                loaded_score("99999999999999999999") == -1, "Scores outside 0-255 are rejected");
+}
+
+void test_commit_column() {
+    printf("\n=== Testing commit_column() ===\n");
+
+    TEST_ASSERT(column_bytes(65536, sizeof(int32_t)) == 262144 && column_bytes(65, 0) == 16 &&
+                column_bytes(0, 0) == 0, "Column sizes, bitmaps in whole words");
+
+    // A column reserved for 4 blocks of 1000 rows, opened up one block and then two more
+    size_t size = column_bytes(4000, sizeof(int32_t));
+    int32_t *column = mmap(NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    TEST_ASSERT(column != MAP_FAILED, "Address range reserved");
+    if (column == MAP_FAILED) return;
+    commit_column(column, sizeof(int32_t), 0, 1000);
+    for (int i = 0; i < 1000; i++) column[i] = i;
+    commit_column(column, sizeof(int32_t), 1000, 3000);
+    int kept = 1, clear = 1;
+    for (int i = 0; i < 1000; i++) kept &= column[i] == i;
+    for (int i = 1000; i < 3000; i++) clear &= column[i] == 0;
+    TEST_ASSERT(kept, "Rows stay where they were while the column grows");
+    TEST_ASSERT(clear, "New rows start out zero");
+    munmap(column, size);
+}
+
+void test_day_number() {
+    printf("\n=== Testing pack_date() and day_number() ===\n");
+
+    TEST_ASSERT(pack_date("2025-08-01") == 20250801 && pack_date("2568-08-01") == 25680801,
+                "Dates pack as YYYYMMDD, BE kept as typed");
+    TEST_ASSERT(pack_date("2025-02-30") == 0 && pack_date("2025-8-1") == 0, "Invalid dates pack as 0");
+    TEST_ASSERT(day_number(19700101) == 0 && day_number(19691231) == -1, "Days count from 1970-01-01");
+    TEST_ASSERT(day_number(25680801) == day_number(20250801), "BE year minus 543 is the same day");
+    TEST_ASSERT(day_number(24000101) == day_number(18570101), "Years from 2400 on are BE");
+    TEST_ASSERT(day_number(20240301) - day_number(20240228) == 2 && day_number(20250301) - day_number(20250228) == 1,
+                "Leap days counted");
+    TEST_ASSERT(day_number(20260101) - day_number(20251231) == 1, "Days run on across a year end");
+}
+
 // ========== MAIN TEST RUNNER ==========
 
 int main() {
@@ -342,12 +1749,26 @@ int main() {
     // Run all test suites
     test_min3();
     test_editDistance();
+    test_editDistanceWithin();
+    test_partialDistanceWithin();
     test_toLowerCase();
     test_trim_whitespace();
     test_is_valid_date();
     test_parseScore();
     test_allocate_string();
+    test_string_pool();
     test_string_edge_cases();
+    test_compute_score_stats();
+    test_crc32c();
+    test_lz_codec();
+    test_csv_reader();
+    test_csv_put_field();
+    test_batch_read_command();
+    test_parse_ndjson_review();
+    test_wal_checksum();
+    test_loaded_score();
+    test_commit_column();
+    test_day_number();
     
     // Print summary
     printf("\n");